@@ -0,0 +1,464 @@
+//
+// Benchmarks of ITensor workloads
+//
+// Usage: ./benchmark [--list] [--json file] [--label str]
+//                    [--nthread n] [--reps n] [name ...]
+//
+// Runs the benchmarks whose names start with one of the
+// given names (all of them if none are given). Setting up
+// the inputs is not timed. Each benchmark is timed over
+// several repetitions, then run once more with the profiler
+// on (and "NThread" 1) to count its flops.
+//
+// Each result is printed, and with --json appended as one
+// line of JSON to the given file, so results of different
+// commits can be collected in one file and compared.
+// Peak RSS is the high water mark of the whole process,
+// so run one benchmark per process (as "make run" does)
+// to get it for each benchmark separately.
+//
+#include <sys/resource.h>
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include "itensor/all.h"
+#include "itensor/util/cputime.h"
+#include "itensor/util/profiler.h"
+
+using namespace itensor;
+using std::string;
+using std::vector;
+
+struct Benchmark
+    {
+    const char* name;
+    const char* description;
+    int reps;
+    //Builds the inputs and returns
+    //the function to be timed
+    std::function<std::function<void()>()> setup;
+    };
+
+struct BenchResult
+    {
+    int reps = 0;
+    Real wall_min = 0;
+    Real wall_median = 0;
+    Real wall_mean = 0;
+    Real cpu_mean = 0;
+    Real gflop = 0;
+    Real peak_rss_mb = 0;
+    };
+
+Real
+peakRSSMB()
+    {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF,&ru);
+#ifdef __APPLE__
+    return ru.ru_maxrss/(1024.*1024.);
+#else
+    return ru.ru_maxrss/1024.;
+#endif
+    }
+
+//
+// Inputs shaped like those of a two-site
+// DMRG step on a spin chain
+//
+
+//Link index of dimension about m with blocks of
+//total Sz = -4,...,4, largest at Sz = 0
+Index
+szLink(int m, string const& tags)
+    {
+    auto qns = Index::qnstorage{};
+    Real wsum = 0;
+    for(int q = -8; q <= 8; q += 2) wsum += std::exp(-q*q/18.);
+    for(int q = -8; q <= 8; q += 2)
+        {
+        auto d = std::max(1l,std::lround(m*std::exp(-q*q/18.)/wsum));
+        qns.emplace_back(QN({"Sz",q}),d);
+        }
+    return Index(std::move(qns),tags);
+    }
+
+Index
+szSite(string const& tags)
+    {
+    return Index(QN({"Sz",+1}),1,QN({"Sz",-1}),1,tags);
+    }
+
+//Link index of a nearest-neighbor Heisenberg MPO
+Index
+szMPOLink(string const& tags)
+    {
+    return Index(QN({"Sz",0}),3,QN({"Sz",+2}),1,QN({"Sz",-2}),1,tags);
+    }
+
+//Two-site wavefunction phi, environments L and R
+//and MPO tensors W1 and W2
+struct TwoSiteProblem
+    {
+    Index l,r,s1,s2;
+    ITensor phi,L,W1,W2,R;
+
+    TwoSiteProblem(int m, bool conserve_qns)
+        {
+        Index w0,w1,w2;
+        if(conserve_qns)
+            {
+            l = szLink(m,"Link,l");
+            r = szLink(m,"Link,r");
+            s1 = szSite("Site,s1");
+            s2 = szSite("Site,s2");
+            w0 = szMPOLink("Link,w0");
+            w1 = szMPOLink("Link,w1");
+            w2 = szMPOLink("Link,w2");
+            }
+        else
+            {
+            l = Index(m,"Link,l");
+            r = Index(m,"Link,r");
+            s1 = Index(2,"Site,s1");
+            s2 = Index(2,"Site,s2");
+            w0 = Index(5,"Link,w0");
+            w1 = Index(5,"Link,w1");
+            w2 = Index(5,"Link,w2");
+            }
+        auto rand = [conserve_qns](IndexSet const& is)
+            {
+            return conserve_qns ? randomITensor(QN(),is) : randomITensor(is);
+            };
+        phi = rand({l,s1,s2,r});
+        phi /= norm(phi);
+        L = rand({dag(l),w0,prime(l)});
+        W1 = rand({dag(w0),dag(s1),prime(s1),w1});
+        W2 = rand({dag(w1),dag(s2),prime(s2),w2});
+        R = rand({dag(r),dag(w2),prime(r)});
+        }
+
+    //Action of the two-site effective Hamiltonian
+    ITensor
+    product() const
+        {
+        auto p = L*phi;
+        p *= W1;
+        p *= W2;
+        p *= R;
+        return p;
+        }
+    };
+
+//
+// Hamiltonians of the models in sample/
+//
+
+MPO
+heisenbergH(SpinHalf const& sites, Real J2 = 0)
+    {
+    auto N = length(sites);
+    auto ampo = AutoMPO(sites);
+    for(int j = 1; j < N; ++j)
+        {
+        ampo += 0.5,"S+",j,"S-",j+1;
+        ampo += 0.5,"S-",j,"S+",j+1;
+        ampo +=     "Sz",j,"Sz",j+1;
+        }
+    if(J2 != 0)
+    for(int j = 1; j < N-1; ++j)
+        {
+        ampo += 0.5*J2,"S+",j,"S-",j+2;
+        ampo += 0.5*J2,"S-",j,"S+",j+2;
+        ampo +=     J2,"Sz",j,"Sz",j+2;
+        }
+    return toMPO(ampo);
+    }
+
+MPS
+neelState(SpinHalf const& sites)
+    {
+    auto state = InitState(sites);
+    for(auto i : range1(length(sites)))
+        {
+        state.set(i,(i%2==1 ? "Up" : "Dn"));
+        }
+    return MPS(state);
+    }
+
+std::function<void()>
+dmrgRun(MPO H, MPS psi0, Sweeps sweeps)
+    {
+    return [H,psi0,sweeps]()
+        {
+        auto psi = psi0;
+        dmrg(psi,H,sweeps,{"Silent",true});
+        };
+    }
+
+vector<Benchmark>
+allBenchmarks()
+    {
+    auto b = vector<Benchmark>{};
+
+    b.push_back({"contract_dense",
+                 "Two-site effective Hamiltonian product, dense, m=256",5,
+                 []()
+                 {
+                 auto P = TwoSiteProblem(256,false);
+                 return std::function<void()>([P]() { P.product(); });
+                 }});
+
+    b.push_back({"contract_qdense",
+                 "Two-site effective Hamiltonian product, Sz blocks, m=800",5,
+                 []()
+                 {
+                 auto P = TwoSiteProblem(800,true);
+                 return std::function<void()>([P]() { P.product(); });
+                 }});
+
+    b.push_back({"svd_qdense",
+                 "svd of a two-site wavefunction with Sz blocks, m=800",5,
+                 []()
+                 {
+                 auto P = TwoSiteProblem(800,true);
+                 return std::function<void()>([P]()
+                     {
+                     ITensor U(P.l,P.s1),S,V;
+                     svd(P.phi,U,S,V,{"MaxDim",800,"Cutoff",1E-12});
+                     });
+                 }});
+
+    b.push_back({"svd_qdense_gesdd",
+                 "svd_qdense using the LAPACK divide-and-conquer driver",5,
+                 []()
+                 {
+                 auto P = TwoSiteProblem(800,true);
+                 return std::function<void()>([P]()
+                     {
+                     ITensor U(P.l,P.s1),S,V;
+                     svd(P.phi,U,S,V,{"MaxDim",800,"Cutoff",1E-12,"SVDMethod","gesdd"});
+                     });
+                 }});
+
+    b.push_back({"diagh_qdense",
+                 "diagHermitian of a two-site density matrix with Sz blocks, m=800",5,
+                 []()
+                 {
+                 auto P = TwoSiteProblem(800,true);
+                 auto rho = P.phi*dag(prime(P.phi,P.l,P.s1));
+                 return std::function<void()>([rho]()
+                     {
+                     diagHermitian(rho,{"MaxDim",800,"Cutoff",1E-12});
+                     });
+                 }});
+
+    b.push_back({"tompo_longrange",
+                 "toMPO of a N=60 Heisenberg chain with 1/r^2 couplings",3,
+                 []()
+                 {
+                 auto N = 60;
+                 auto sites = SpinHalf(N);
+                 auto ampo = AutoMPO(sites);
+                 for(int i = 1; i <= N; ++i)
+                 for(int j = i+1; j <= N; ++j)
+                     {
+                     auto J = 1./((j-i)*(j-i));
+                     ampo += 0.5*J,"S+",i,"S-",j;
+                     ampo += 0.5*J,"S-",i,"S+",j;
+                     ampo +=     J,"Sz",i,"Sz",j;
+                     }
+                 return std::function<void()>([ampo]() { toMPO(ampo); });
+                 }});
+
+    b.push_back({"dmrg_heisenberg",
+                 "DMRG, N=100 S=1/2 Heisenberg chain, 5 sweeps up to m=200",1,
+                 []()
+                 {
+                 auto sites = SpinHalf(100);
+                 auto sweeps = Sweeps(5);
+                 sweeps.maxdim() = 10,20,100,100,200;
+                 sweeps.cutoff() = 1E-10;
+                 return dmrgRun(heisenbergH(sites),neelState(sites),sweeps);
+                 }});
+
+    b.push_back({"dmrg_j1j2",
+                 "DMRG, N=60 J1-J2 chain with J2=0.35, 5 sweeps up to m=200",1,
+                 []()
+                 {
+                 auto sites = SpinHalf(60);
+                 auto sweeps = Sweeps(5);
+                 sweeps.maxdim() = 50,50,100,100,200;
+                 sweeps.cutoff() = 1E-10;
+                 return dmrgRun(heisenbergH(sites,0.35),neelState(sites),sweeps);
+                 }});
+
+    b.push_back({"dmrg_hubbard",
+                 "DMRG, N=24 Hubbard chain at half filling with U=4, 5 sweeps up to m=300",1,
+                 []()
+                 {
+                 auto N = 24;
+                 auto sites = Electron(N);
+                 auto ampo = AutoMPO(sites);
+                 for(int i = 1; i <= N; ++i) ampo += 4.,"Nupdn",i;
+                 for(int j = 1; j < N; ++j)
+                     {
+                     ampo += -1.,"Cdagup",j,"Cup",j+1;
+                     ampo += -1.,"Cdagup",j+1,"Cup",j;
+                     ampo += -1.,"Cdagdn",j,"Cdn",j+1;
+                     ampo += -1.,"Cdagdn",j+1,"Cdn",j;
+                     }
+                 auto state = InitState(sites);
+                 for(int i = 1; i <= N; ++i) state.set(i,(i%2==1 ? "Up" : "Dn"));
+                 auto sweeps = Sweeps(5);
+                 sweeps.maxdim() = 50,100,200,300,300;
+                 sweeps.cutoff() = 1E-10;
+                 return dmrgRun(toMPO(ampo),MPS(state),sweeps);
+                 }});
+
+    b.push_back({"tebd_heisenberg",
+                 "TEBD, N=40 Heisenberg chain from the Neel state, 40 steps up to m=128",1,
+                 []()
+                 {
+                 auto N = 40;
+                 auto tstep = 0.05;
+                 auto sites = SpinHalf(N);
+                 auto gates = vector<BondGate>{};
+                 for(int b = 1; b < N; ++b)
+                     {
+                     auto hterm = op(sites,"Sz",b)*op(sites,"Sz",b+1);
+                     hterm += 0.5*op(sites,"S+",b)*op(sites,"S-",b+1);
+                     hterm += 0.5*op(sites,"S-",b)*op(sites,"S+",b+1);
+                     gates.emplace_back(sites,b,b+1,BondGate::tReal,tstep/2.,hterm);
+                     }
+                 for(int b = N-1; b >= 1; --b)
+                     {
+                     gates.push_back(gates.at(b-1));
+                     }
+                 auto psi0 = neelState(sites);
+                 return std::function<void()>([gates,psi0,tstep]()
+                     {
+                     auto psi = psi0;
+                     gateTEvol(gates,40*tstep,tstep,psi,{"MaxDim",128,"Cutoff",1E-10,
+                                                         "Verbose",false,"ShowPercent",false});
+                     });
+                 }});
+
+    return b;
+    }
+
+BenchResult
+runBenchmark(Benchmark const& b, int reps)
+    {
+    seedRNG(1);
+    auto f = b.setup();
+    auto res = BenchResult{};
+    res.reps = reps;
+
+    auto walls = vector<Real>{};
+    for(int r = 0; r < reps; ++r)
+        {
+        auto t = cpu_time();
+        f();
+        auto dt = t.sincemark();
+        walls.push_back(dt.wall);
+        res.cpu_mean += dt.time/reps;
+        }
+    std::sort(walls.begin(),walls.end());
+    res.wall_min = walls.front();
+    res.wall_median = walls[walls.size()/2];
+    for(auto w : walls) res.wall_mean += w/reps;
+
+    //Count flops in a separate, untimed run. Work handed to
+    //other threads would not be counted inside the scope,
+    //so use a single thread.
+    auto nthread = Args::global().getInt("NThread",1);
+    Args::global().add("NThread",1);
+    profiler().reset();
+    profiler().enable();
+        {
+        PROFILE_SCOPE(b.name)
+        f();
+        }
+    profiler().enable(false);
+    Args::global().add("NThread",nthread);
+    res.gflop = 1E-9*profiler().stats(b.name).flops;
+
+    res.peak_rss_mb = peakRSSMB();
+    return res;
+    }
+
+bool
+startsWith(string const& s, string const& prefix)
+    {
+    return s.compare(0,prefix.size(),prefix) == 0;
+    }
+
+int
+main(int argc, char* argv[])
+    {
+    auto jsonfile = string();
+    auto label = string();
+    auto nthread = 1;
+    auto reps = 0;
+    auto list = false;
+    auto names = vector<string>{};
+    for(int n = 1; n < argc; ++n)
+        {
+        auto arg = string(argv[n]);
+        auto next = [&]()
+            {
+            if(n+1 >= argc) Error(format("benchmark: missing value after %s",arg));
+            return string(argv[++n]);
+            };
+        if(arg == "--list")         list = true;
+        else if(arg == "--json")    jsonfile = next();
+        else if(arg == "--label")   label = next();
+        else if(arg == "--nthread") nthread = std::stoi(next());
+        else if(arg == "--reps")    reps = std::stoi(next());
+        else if(startsWith(arg,"-")) Error(format("benchmark: unknown option %s",arg));
+        else                        names.push_back(arg);
+        }
+
+    auto benchmarks = allBenchmarks();
+    auto selected = vector<Benchmark>{};
+    for(auto& b : benchmarks)
+        {
+        auto use = names.empty();
+        for(auto& name : names) if(startsWith(b.name,name)) use = true;
+        if(use) selected.push_back(b);
+        }
+    if(selected.empty()) Error("benchmark: no benchmark matches the given names");
+
+    if(list)
+        {
+        for(auto& b : selected) println(b.name);
+        return 0;
+        }
+
+    Args::global().add("NThread",nthread);
+
+    for(auto& b : selected)
+        {
+        auto res = runBenchmark(b,reps > 0 ? reps : b.reps);
+        auto gflops = res.wall_min > 0 ? res.gflop/res.wall_min : 0.;
+        printfln("%-16s %s",b.name,b.description);
+        printfln("%-16s reps %d, wall min %.4f median %.4f mean %.4f s, cpu mean %.4f s",
+                 "",res.reps,res.wall_min,res.wall_median,res.wall_mean,res.cpu_mean);
+        printfln("%-16s %.3f GFlop, %.2f GFlop/s, peak RSS %.1f MB",
+                 "",res.gflop,gflops,res.peak_rss_mb);
+        if(!jsonfile.empty())
+            {
+            std::ofstream f(jsonfile,std::ios::app);
+            if(!f) Error(format("benchmark: could not open %s",jsonfile));
+            f << format("{\"name\":\"%s\",\"label\":\"%s\",\"nthread\":%d,\"reps\":%d,"
+                        "\"wall_min\":%.6f,\"wall_median\":%.6f,\"wall_mean\":%.6f,"
+                        "\"cpu_mean\":%.6f,\"gflop\":%.6f,\"gflops\":%.4f,\"peak_rss_mb\":%.2f}\n",
+                        b.name,label,nthread,res.reps,
+                        res.wall_min,res.wall_median,res.wall_mean,
+                        res.cpu_mean,res.gflop,gflops,res.peak_rss_mb);
+            }
+        }
+
+    return 0;
+    }
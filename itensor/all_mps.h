@@ -36,6 +36,7 @@
 
 #include "itensor/mps/dmrg.h"
 #include "itensor/mps/tevol.h"
+#include "itensor/mps/tdvp.h"
 #include "itensor/mps/autompo.h"
 
 #include "itensor/mps/lattice/square.h"
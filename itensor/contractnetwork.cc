@@ -0,0 +1,335 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include "itensor/contractnetwork.h"
+
+namespace itensor {
+
+using std::vector;
+
+//Indices of a network, numbered 0,1,2,...
+//
+//o dims[k] is the dimension of index k
+//o inds[t] lists the index numbers of tensor t, sorted
+//o holders[k] lists the tensors which have index k
+//
+struct NetworkInds
+    {
+    vector<Real> dims;
+    vector<vector<long>> inds;
+    vector<vector<long>> holders;
+    };
+
+NetworkInds static
+networkInds(vector<IndexSet> const& is)
+    {
+    auto N = NetworkInds{};
+    auto all = vector<Index>{};
+    N.inds.resize(is.size());
+    for(auto t : range(is))
+        {
+        for(auto& i : is[t])
+            {
+            auto k = std::find(all.begin(),all.end(),i)-all.begin();
+            if(k == long(all.size()))
+                {
+                all.push_back(i);
+                N.dims.push_back(dim(i));
+                N.holders.emplace_back();
+                }
+            if(N.holders[k].size() == 2)
+                {
+                println("Index = ",i);
+                Error("contractionSequence: index appears on more than two tensors");
+                }
+            N.holders[k].push_back(t);
+            N.inds[t].push_back(k);
+            }
+        std::sort(N.inds[t].begin(),N.inds[t].end());
+        }
+    return N;
+    }
+
+Real static
+sizeOf(NetworkInds const& N, vector<long> const& inds)
+    {
+    Real s = 1.;
+    for(auto k : inds) s *= N.dims[k];
+    return s;
+    }
+
+//Indices of the product of tensors
+//with (sorted) indices a and b
+vector<long> static
+productInds(vector<long> const& a, vector<long> const& b)
+    {
+    auto c = vector<long>{};
+    std::set_symmetric_difference(a.begin(),a.end(),b.begin(),b.end(),
+                                  std::back_inserter(c));
+    return c;
+    }
+
+//Multiply-adds for contracting tensors
+//with (sorted) indices a and b
+Real static
+contractFlops(NetworkInds const& N, vector<long> const& a, vector<long> const& b)
+    {
+    auto u = vector<long>{};
+    std::set_union(a.begin(),a.end(),b.begin(),b.end(),std::back_inserter(u));
+    return sizeOf(N,u);
+    }
+
+void static
+computeCost(NetworkInds const& N, ContractionSequence & seq)
+    {
+    auto ind = N.inds;
+    auto size = vector<Real>(ind.size());
+    Real live = 0.;
+    for(auto t : range(ind))
+        {
+        size[t] = sizeOf(N,ind[t]);
+        live += size[t];
+        }
+    seq.flops = 0.;
+    seq.peakMemory = live;
+    for(auto& st : seq.steps)
+        {
+        auto& a = ind.at(st.first);
+        auto& b = ind.at(st.second);
+        seq.flops += contractFlops(N,a,b);
+        ind.push_back(productInds(a,b));
+        size.push_back(sizeOf(N,ind.back()));
+        live += size.back();
+        seq.peakMemory = std::max(seq.peakMemory,live);
+        live -= size[st.first]+size[st.second];
+        }
+    }
+
+//
+// Optimal order by dynamic programming over
+// subsets of the tensors: the best way to contract
+// a subset S is the cheapest split of S into
+// two parts, each contracted in its best way.
+// Takes O(3^N) steps and O(2^N) memory.
+//
+ContractionSequence static
+exhaustiveSequence(NetworkInds const& N)
+    {
+    auto ntensor = long(N.inds.size());
+    if(ntensor > MAX_EXHAUSTIVE) Error("exhaustiveSequence: too many tensors");
+    auto nsubset = 1ul << ntensor;
+
+    //size of the tensor left after contracting
+    //all tensors in subset S: product of dims of
+    //indices not shared between S and the others
+    auto ssize = vector<Real>(nsubset,1.);
+    for(auto S : range(nsubset))
+    for(auto k : range(N.dims))
+        {
+        auto nin = 0;
+        for(auto t : N.holders[k]) if(S & (1ul << t)) ++nin;
+        if(nin == 1) ssize[S] *= N.dims[k];
+        }
+
+    auto cost = vector<Real>(nsubset,std::numeric_limits<Real>::max());
+    auto split = vector<unsigned long>(nsubset,0);
+    for(auto t : range(ntensor)) cost[1ul << t] = 0.;
+    for(auto S : range(nsubset))
+        {
+        if((S & (S-1)) == 0) continue;
+        auto low = S & (~S+1);
+        //Loop over subsets S1 of S containing its lowest
+        //tensor, so each split is considered once
+        for(auto S1 = (S-1) & S; S1 > 0; S1 = (S1-1) & S)
+            {
+            if(!(S1 & low)) continue;
+            auto S2 = S ^ S1;
+            //Multiply-adds for contracting the two parts:
+            //product of dims of all indices on either part
+            auto c = cost[S1]+cost[S2]+std::sqrt(ssize[S1]*ssize[S2]*ssize[S]);
+            if(c < cost[S])
+                {
+                cost[S] = c;
+                split[S] = S1;
+                }
+            }
+        }
+
+    auto seq = ContractionSequence{};
+    //Returns the number of the tensor made by contracting S
+    std::function<long(unsigned long)> emit = [&](unsigned long S) -> long
+        {
+        if((S & (S-1)) == 0)
+            {
+            long t = 0;
+            while(!(S & (1ul << t))) ++t;
+            return t;
+            }
+        auto a = emit(split[S]);
+        auto b = emit(S ^ split[S]);
+        seq.steps.emplace_back(a,b);
+        return ntensor+long(seq.steps.size())-1;
+        };
+    emit(nsubset-1);
+    return seq;
+    }
+
+//
+// Greedy order: repeatedly contract the pair of tensors
+// sharing an index whose product most reduces the total
+// size of the tensors left, breaking ties by fewest
+// multiply-adds. Tensors with no common indices are only
+// multiplied (smallest first) once no such pairs remain.
+//
+ContractionSequence static
+greedySequence(NetworkInds const& N)
+    {
+    auto seq = ContractionSequence{};
+    auto ind = N.inds;
+    auto alive = vector<long>(ind.size());
+    for(auto t : range(ind)) alive[t] = t;
+
+    while(alive.size() > 1)
+        {
+        auto besta = -1l,
+             bestb = -1l;
+        auto bestdsize = std::numeric_limits<Real>::max(),
+             bestflops = std::numeric_limits<Real>::max();
+        for(auto a : range(alive))
+        for(auto b : range(a+1,alive.size()))
+            {
+            auto& ia = ind[alive[a]];
+            auto& ib = ind[alive[b]];
+            auto ic = productInds(ia,ib);
+            if(ic.size() == ia.size()+ib.size()) continue;
+            auto dsize = sizeOf(N,ic)-sizeOf(N,ia)-sizeOf(N,ib);
+            auto flops = contractFlops(N,ia,ib);
+            if(dsize < bestdsize || (dsize == bestdsize && flops < bestflops))
+                {
+                besta = a;
+                bestb = b;
+                bestdsize = dsize;
+                bestflops = flops;
+                }
+            }
+        if(besta < 0)
+            {
+            //No pair shares an index: outer product
+            //of the two smallest tensors
+            std::sort(alive.begin(),alive.end(),[&](long a, long b)
+                { return sizeOf(N,ind[a]) < sizeOf(N,ind[b]); });
+            besta = 0;
+            bestb = 1;
+            }
+        auto a = alive[besta];
+        auto b = alive[bestb];
+        seq.steps.emplace_back(a,b);
+        ind.push_back(productInds(ind[a],ind[b]));
+        alive.erase(alive.begin()+bestb);
+        alive.erase(alive.begin()+besta);
+        alive.push_back(ind.size()-1);
+        }
+    return seq;
+    }
+
+ContractionSequence
+contractionSequence(vector<IndexSet> const& is,
+                    Args const& args)
+    {
+    auto max_exhaustive = std::min(args.getInt("MaxExhaustive",8),long(MAX_EXHAUSTIVE));
+    if(is.empty()) Error("contractionSequence: no tensors");
+
+    auto N = networkInds(is);
+    auto seq = ContractionSequence{};
+    if(is.size() == 1)
+        {
+        //nothing to contract
+        }
+    else if(long(is.size()) <= max_exhaustive)
+        {
+        seq = exhaustiveSequence(N);
+        }
+    else
+        {
+        seq = greedySequence(N);
+        }
+    computeCost(N,seq);
+    return seq;
+    }
+
+ContractionSequence
+contractionSequence(vector<ITensor> const& T,
+                    Args const& args)
+    {
+    auto is = vector<IndexSet>(T.size());
+    for(auto n : range(T)) is[n] = T[n].inds();
+    return contractionSequence(is,args);
+    }
+
+ITensor
+contractNetwork(vector<ITensor> const& T,
+                ContractionSequence const& seq)
+    {
+    if(T.empty()) Error("contractNetwork: no tensors");
+    if(seq.steps.size()+1 != T.size())
+        {
+        Error("contractNetwork: wrong number of steps in ContractionSequence");
+        }
+    if(T.size() == 1) return T.front();
+
+    //Intermediates are moved out once used,
+    //the inputs are only copied when first used
+    auto R = vector<ITensor>(T.size()+seq.steps.size());
+    auto used = vector<bool>(R.size(),false);
+    auto take = [&](long n) -> ITensor
+        {
+        if(n < 0 || n >= long(T.size())+long(seq.steps.size()) || used.at(n))
+            {
+            Error("contractNetwork: invalid ContractionSequence");
+            }
+        used[n] = true;
+        if(n < long(T.size())) return T[n];
+        return std::move(R[n]);
+        };
+    for(auto s : range(seq.steps))
+        {
+        auto A = take(seq.steps[s].first);
+        auto B = take(seq.steps[s].second);
+        R[T.size()+s] = A*B;
+        }
+    return std::move(R.back());
+    }
+
+ITensor
+contractNetwork(vector<ITensor> const& T,
+                Args const& args)
+    {
+    return contractNetwork(T,contractionSequence(T,args));
+    }
+
+std::ostream&
+operator<<(std::ostream & s, ContractionSequence const& seq)
+    {
+    s << "ContractionSequence:\n";
+    for(auto& st : seq.steps) s << "  (" << st.first << "," << st.second << ")\n";
+    s << "  flops = " << seq.flops << ", peak memory = " << seq.peakMemory;
+    return s;
+    }
+
+} //namespace itensor
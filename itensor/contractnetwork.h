@@ -0,0 +1,90 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_CONTRACTNETWORK_H
+#define __ITENSOR_CONTRACTNETWORK_H
+
+#include "itensor/itensor.h"
+
+namespace itensor {
+
+//
+// ContractionSequence - an order in which to
+// contract a list of ITensors T[0],...,T[N-1]
+// two at a time
+//
+// o The input tensors are numbered 0,...,N-1.
+//   Step n contracts the two tensors numbered
+//   steps[n].first and steps[n].second, and
+//   its result is numbered N+n.
+// o flops is the estimated number of
+//   multiply-adds, assuming dense storage
+// o peakMemory is the largest number of tensor
+//   elements held at once (inputs, intermediates
+//   and result), assuming dense storage
+//
+struct ContractionSequence
+    {
+    std::vector<std::pair<long,long>> steps;
+    Real flops = 0.;
+    Real peakMemory = 0.;
+    };
+
+//
+// Find a cheap order in which to contract the
+// tensors in T, using only their indices.
+//
+// Each index may appear on at most two tensors.
+// Tries all orders when T has at most "MaxExhaustive"
+// tensors (default 8), otherwise repeatedly contracts
+// the pair which most reduces the total size
+// of the tensors left.
+//
+// Trying all orders takes time and memory exponential
+// in the number of tensors, so larger values of
+// "MaxExhaustive" are treated as MAX_EXHAUSTIVE.
+//
+const int MAX_EXHAUSTIVE = 16;
+
+ContractionSequence
+contractionSequence(std::vector<ITensor> const& T,
+                    Args const& args = Args::global());
+
+ContractionSequence
+contractionSequence(std::vector<IndexSet> const& is,
+                    Args const& args = Args::global());
+
+//
+// Contract the tensors in T using
+// the sequence seq (or a sequence from
+// contractionSequence if none is given)
+//
+// Gives the same result as T[0]*T[1]*...*T[N-1]
+// up to the order of the indices.
+//
+ITensor
+contractNetwork(std::vector<ITensor> const& T,
+                ContractionSequence const& seq);
+
+ITensor
+contractNetwork(std::vector<ITensor> const& T,
+                Args const& args = Args::global());
+
+std::ostream&
+operator<<(std::ostream & s, ContractionSequence const& seq);
+
+} //namespace itensor
+
+#endif
@@ -29,6 +29,7 @@
 //
 
 #include "itensor/decomp.h"
+#include "itensor/contractnetwork.h"
 #include "itensor/iterativesolvers.h"
 #include "itensor/util/autovector.h"
 #include "itensor/util/readwrite.h"
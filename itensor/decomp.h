@@ -15,6 +15,7 @@
 //
 #ifndef __ITENSOR_DECOMP_H
 #define __ITENSOR_DECOMP_H
+#include <numeric>
 #include "itensor/util/print_macro.h"
 #include "itensor/spectrum.h"
 #include "itensor/itensor.h"
@@ -28,6 +29,23 @@ namespace itensor {
 // Factors a tensor AA such that AA=U*D*V
 // with D diagonal, real, and non-negative.
 //
+// The Arg "SVDMethod" chooses how the SVD of each block is
+// computed: "recursive" (default) diagonalizes M*M^dagger and
+// refines singular values smaller than "SVDThreshold" times
+// the largest, while "gesdd" and "gesvd" call the LAPACK
+// divide-and-conquer and QR iteration drivers.
+//
+// With the Arg "RandomSVD" true (and truncation on), each
+// block is factored only up to its rank+"Oversample" (default
+// 10) largest singular values by randomized range finding
+// with "PowerIters" (default 2) power iterations. The rank
+// starts at "RankGuess" (default MaxDim) and is doubled, up
+// to MaxDim, until the weight left out is below the cutoff.
+// If the weight left out at rank MaxDim is still more than
+// "RandomSVDTol" (default 1E-6) of the total weight, the full
+// SVD is used instead. The weight left out counts as discarded
+// in the truncation error.
+//
 Spectrum 
 svd(ITensor AA, ITensor& U, ITensor& D, ITensor& V, 
     Args args = Args::global());
@@ -316,8 +334,9 @@ denmatDecomp(ITensor const& AA,
         if(!hasIndex(newoc,I)) cinds.push_back(I);
         }
 
+    PROFILE_SCOPE("denmatDecomp")
+
     //Apply combiner
-    START_TIMER(8)
     auto [cmb,ci] = combiner(std::move(cinds),args);
     //auto ci = cmb.inds().front();
 
@@ -337,8 +356,6 @@ denmatDecomp(ITensor const& AA,
         if(tr > 1E-16) rho *= 1./tr;
         }
 
-    STOP_TIMER(8)
-
     if(args.getBool("UseOrigM",false))
         {
         args.add("Cutoff",-1);
@@ -411,6 +428,25 @@ std::vector<Ord2Block<T>>
 doTask(GetBlocks<T> const& G, 
        QDense<T> const& d);
 
+//Order in which to factorize blocks
+//so that the most costly are started first
+template<typename T>
+std::vector<size_t>
+blockOrder(std::vector<Ord2Block<T>> const& blocks)
+    {
+    auto cost = [&blocks](size_t b)
+        {
+        auto r = Real(nrows(blocks[b].M)),
+             c = Real(ncols(blocks[b].M));
+        return r*c*std::min(r,c);
+        };
+    auto order = std::vector<size_t>(blocks.size());
+    std::iota(order.begin(),order.end(),0);
+    std::stable_sort(order.begin(),order.end(),
+                     [&cost](size_t a, size_t b) { return cost(a) > cost(b); });
+    return order;
+    }
+
 void
 showEigs(Vector const& P,
          Real truncerr,
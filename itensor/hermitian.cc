@@ -20,6 +20,7 @@
 #include "itensor/decomp.h"
 #include "itensor/util/print_macro.h"
 #include "itensor/itdata/qutil.h"
+#include "itensor/util/threadpool.h"
 
 namespace itensor {
 
@@ -44,6 +45,7 @@ diagHImpl(ITensor H,
           ITensor& D,
           Args args)
     {
+    PROFILE_SCOPE("diagHermitian")
     if( args.defined("Minm") )
       {
       if( args.defined("MinDim") )
@@ -179,7 +181,6 @@ diagHImpl(ITensor H,
         }
     else  // With QNs
         {
-        SCOPED_TIMER(7)
         auto compute_qns = args.getBool("ComputeQNs",false);
 
         if(H.order() != 2)
@@ -221,28 +222,38 @@ diagHImpl(ITensor H,
         auto ddata = vector<Real>(totaldsize);
         auto dvecs = vector<VectorRef>(Nblock);
 
-        auto alleig = stdx::reserve_vector<Real>(dim(ai));
-        auto alleigqn = vector<EigQN>{};
-        if(compute_qns) alleigqn = stdx::reserve_vector<EigQN>(dim(ai));
-
-        //1. Diagonalize each ITensor within H.
-        //   Store results in mmatrix and mvector.
         totaldsize = 0;
         totalUsize = 0;
         for(auto b : range(Nblock))
             {
-            auto& M = blocks[b].M;
-            auto& UU = Umats.at(b);
-            auto& d =  dvecs.at(b);
-            auto rM = nrows(M),
-                 cM = ncols(M);
+            auto rM = nrows(blocks[b].M),
+                 cM = ncols(blocks[b].M);
+            dvecs[b] = makeVecRef(ddata.data()+totaldsize,rM);
+            Umats[b] = makeMatRef(Udata.data()+totalUsize,rM*cM,rM,cM);
+            totaldsize += rM;
+            totalUsize += rM*cM;
+            }
 
-            d = makeVecRef(ddata.data()+totaldsize,rM);
-            UU = makeMatRef(Udata.data()+totalUsize,rM*cM,rM,cM);
+        //1. Diagonalize each block of H concurrently,
+        //   largest first, storing results in Umats and dvecs.
+        auto order = blockOrder(blocks);
+        auto diagBlock = [&](long n)
+            {
+            auto b = order[n];
+            diagHermitian(blocks[b].M,Umats[b],dvecs[b]);
+            conjugate(Umats[b]);
+            };
+        auto nthread = Args::global().getInt("NThread",1);
+        if(nthread > 1) threadPool(nthread).run(Nblock,diagBlock,nthread);
+        else            for(auto n : range(Nblock)) diagBlock(n);
 
-            diagHermitian(M,UU,d);
-            conjugate(UU);
+        auto alleig = stdx::reserve_vector<Real>(dim(ai));
+        auto alleigqn = vector<EigQN>{};
+        if(compute_qns) alleigqn = stdx::reserve_vector<EigQN>(dim(ai));
 
+        for(auto b : range(Nblock))
+            {
+            auto& d = dvecs[b];
             alleig.insert(alleig.end(),d.begin(),d.end());
             if(compute_qns)
                 {
@@ -253,11 +264,8 @@ diagHImpl(ITensor H,
                     alleigqn.emplace_back(eig,q);
                     }
                 }
-            totaldsize += rM;
-            totalUsize += rM*cM;
             }
 
-
         //2. Truncate eigenvalues
 
         stdx::sort(alleig,std::greater<Real>{});
@@ -256,6 +256,8 @@ doTask(Contract & C,
        Dense<T2> const& R,
        ManageStore & m)
     {
+    PROFILE_SCOPE("contract")
+    countContract();
     //if(not C.needresult)
     //    {
     //    m.makeNewData<ITLazy>(C.Lis,m.parg1(),C.Ris,m.parg2());
@@ -294,23 +296,17 @@ doTask(Contract & C,
     auto tL = makeTenRef(L.data(),L.size(),&C.Lis);
     auto tR = makeTenRef(R.data(),R.size(),&C.Ris);
     auto rsize = dim(C.Nis);
-    START_TIMER(4)
     auto nd = m.makeNewData<Dense<common_type<T1,T2>>>(rsize);
-    STOP_TIMER(4)
     auto tN = makeTenRef(nd->data(),nd->size(),&(C.Nis));
 
 #ifdef COLLECT_TSTATS
     tstats(tL,Lind,tR,Rind,tN,Nind);
 #endif
 
-    START_TIMER(2)
     contract(tL,Lind,tR,Rind,tN,Nind);
-    STOP_TIMER(2)
 
 #ifdef USESCALE
-    START_TIMER(3)
     if(rsize > 1) C.scalefac = computeScalefac(*nd);
-    STOP_TIMER(3)
 #endif
     }
 template void doTask(Contract&,DenseReal const&,DenseReal const&,ManageStore&);
@@ -19,7 +19,8 @@
 #include <memory>
 #include "itensor/types.h"
 #include "itensor/util/error.h"
-#include "itensor/util/timers.h"
+#include "itensor/util/profiler.h"
+#include "itensor/util/counters.h"
 #include "itensor/itdata/storage_types.h"
 
 namespace itensor {
@@ -86,6 +87,23 @@ struct ITData
     plugInto(FuncBase& f) = 0;
     };
 
+namespace detail {
+
+//Bytes held by storage types with
+//data() and size() (such as Dense and QDense)
+template<typename T>
+auto
+storageBytes(stdx::choice<1>, T const& d) -> decltype(d.size()*sizeof(*d.data()))
+    {
+    return d.size()*sizeof(*d.data());
+    }
+
+template<typename T>
+size_t
+storageBytes(stdx::choice<2>, T const& d) { return 0; }
+
+} //namespace detail
+
 template<typename T>
 class ITWrap : public ITData
     {
@@ -94,12 +112,22 @@ class ITWrap : public ITData
 
     T d;
 
+    private:
+    //Bytes counted as allocated by countAlloc
+    size_t bytes_ = 0;
+    public:
+
     template<typename... VArgs>
     ITWrap(VArgs&&... vargs) : d(std::forward<VArgs>(vargs)...) 
         { 
+        bytes_ = detail::storageBytes(stdx::select_overload{},d);
+        if(bytes_ > 0) countAlloc(bytes_);
         }
 
-    virtual ~ITWrap() { }
+    virtual ~ITWrap()
+        {
+        if(bytes_ > 0) countFree(bytes_);
+        }
 
     private:
     
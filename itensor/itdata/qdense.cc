@@ -14,6 +14,8 @@
 // limitations under the License.
 //
 //#include "itensor/util/iterate.h"
+#include <map>
+#include <tuple>
 #include "itensor/detail/gcounter.h"
 #include "itensor/detail/algs.h"
 #include "itensor/tensor/lapack_wrap.h"
@@ -22,6 +24,7 @@
 #include "itensor/itdata/dense.h"
 #include "itensor/itdata/qdense.h"
 #include "itensor/itdata/qutil.h"
+#include "itensor/util/threadpool.h"
 #include "itensor/util/print_macro.h"
 
 using std::vector;
@@ -461,6 +464,152 @@ template void doTask(PlusEQ const&, QDense<Cplx> const&, QDense<Real> const&, Ma
 template void doTask(PlusEQ const&, QDense<Cplx> const&, QDense<Cplx> const&, ManageStore&);
 
 
+size_t static
+hashKey(BlockPlanCache::key_type const& key)
+    {
+    size_t h = key.size();
+    for(auto k : key) h ^= std::hash<long>()(k) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+    }
+
+BlockContractPlan const* BlockPlanCache::
+find(key_type const& key)
+    {
+    auto h = hashKey(key);
+    for(auto it = items_.begin(); it != items_.end(); ++it)
+        {
+        if(it->hash == h && it->key == key)
+            {
+            //Move to front, marking as most recently used
+            items_.splice(items_.begin(),items_,it);
+            ++hits_;
+            return &(items_.front().plan);
+            }
+        }
+    ++misses_;
+    return nullptr;
+    }
+
+BlockContractPlan const& BlockPlanCache::
+insert(key_type && key, BlockContractPlan && plan)
+    {
+    auto h = hashKey(key);
+    items_.push_front(Item{h,std::move(key),std::move(plan)});
+    while(items_.size() > std::max(maxsize_,size_t(1))) items_.pop_back();
+    //(With maxsize_ == 0 the newest plan is still
+    // kept until the next insert, since a reference
+    // to it is returned)
+    return items_.front().plan;
+    }
+
+void BlockPlanCache::
+setMaxSize(size_t maxsize)
+    {
+    maxsize_ = maxsize;
+    while(items_.size() > maxsize_) items_.pop_back();
+    }
+
+BlockPlanCache&
+blockPlanCache()
+    {
+    static thread_local BlockPlanCache cache;
+    return cache;
+    }
+
+//Everything a BlockContractPlan for C = A*B
+//depends on: the labels, the block structure 
+//of the IndexSets and the block offsets of A, B and C
+template<typename VA, typename VB, typename VC>
+BlockPlanCache::key_type
+blockPlanKey(Contract const& Con,
+             Labels const& Lind,
+             Labels const& Rind,
+             QDense<VA> const& A,
+             QDense<VB> const& B,
+             QDense<VC> const& C)
+    {
+    auto key = BlockPlanCache::key_type{};
+    auto addLabels = [&key](Labels const& ind)
+        {
+        key.push_back(ind.size());
+        key.insert(key.end(),ind.begin(),ind.end());
+        };
+    auto addBlocks = [&key](IndexSet const& is)
+        {
+        key.push_back(order(is));
+        for(auto& I : is)
+            {
+            key.push_back(I.nblock());
+            for(auto b : range(I.nblock())) key.push_back(I.blocksize0(b));
+            }
+        };
+    auto addOffsets = [&key](std::vector<BlOf> const& offsets)
+        {
+        key.push_back(offsets.size());
+        for(auto& bo : offsets)
+            {
+            key.push_back(bo.block);
+            key.push_back(bo.offset);
+            }
+        };
+    addLabels(Lind);
+    addLabels(Rind);
+    addBlocks(Con.Lis);
+    addBlocks(Con.Ris);
+    addBlocks(Con.Nis);
+    addOffsets(A.offsets);
+    addOffsets(B.offsets);
+    addOffsets(C.offsets);
+    return key;
+    }
+
+//Collect the entries of plan which are small
+//matrix products into batches of the same shape
+void
+batchBlockGemms(BlockContractPlan & plan,
+                Contract const& Con,
+                Labels const& Lind,
+                Labels const& Rind,
+                Labels const& Cind)
+    {
+    using BatchKey = std::tuple<GemmShape,bool,long>;
+    //Entries with the same shape writing to the same
+    //block of C go into successive batches
+    auto nsame = std::map<BatchKey,long>{};
+    auto index = std::map<BatchKey,long>{};
+    plan.batches.clear();
+    plan.batchOf.assign(plan.entries.size(),-1);
+    for(auto n : range(plan.entries))
+        {
+        auto& e = plan.entries[n];
+        Range Arange,
+              Brange,
+              Crange;
+        Arange.init(make_indexdim(Con.Lis,e.Ablockind));
+        Brange.init(make_indexdim(Con.Ris,e.Bblockind));
+        Crange.init(make_indexdim(Con.Nis,e.Cblockind));
+        auto shape = GemmShape{};
+        auto swapAB = false;
+        if(!contractAsGemm(Arange,Lind,Brange,Rind,Crange,Cind,shape,swapAB)
+           || !isSmallGemm(shape))
+            {
+            continue;
+            }
+        auto round = nsame[BatchKey{shape,swapAB,e.coffset}]++;
+        auto key = BatchKey{shape,swapAB,round};
+        auto it = index.find(key);
+        if(it == index.end())
+            {
+            it = index.emplace(key,long(plan.batches.size())).first;
+            plan.batches.emplace_back();
+            plan.batches.back().shape = shape;
+            plan.batches.back().swapAB = swapAB;
+            }
+        plan.batches[it->second].entries.push_back(n);
+        plan.batchOf[n] = it->second;
+        }
+    }
+
 template<typename VA, typename VB>
 void
 doTask(Contract& Con,
@@ -468,6 +617,8 @@ doTask(Contract& Con,
        QDense<VB> const& B,
        ManageStore& m)
     {
+    PROFILE_SCOPE("contract")
+    countContract();
     using VC = common_type<VA,VB>;
     Labels Lind,
           Rind;
@@ -480,9 +631,7 @@ doTask(Contract& Con,
     auto Cdiv = doTask(CalcDiv{Con.Lis},A)+doTask(CalcDiv{Con.Ris},B);
 
     //Allocate storage for C
-    START_TIMER(33)
     auto nd = m.makeNewData<QDense<VC>>(Con.Nis,Cdiv);
-    STOP_TIMER(33)
     auto& C = *nd;
 
     //Function to execute for each pair of
@@ -509,22 +658,89 @@ doTask(Contract& Con,
         auto cref = makeRef(cblock,&Crange);
 
         //Compute cref += aref*bref
-        START_TIMER(2)
         contract(aref,Lind,bref,Rind,cref,Cind,1.,1.);
-        STOP_TIMER(2)
         };
 
-    START_TIMER(20)
-    loopContractedBlocks(A,Con.Lis,
-                         B,Con.Ris,
-                         C,Con.Nis,
-                         do_contract);
-    STOP_TIMER(20)
+    //Set "NThread" in Args::global() to contract
+    //pairs of blocks on more than one thread
+    auto nthread = Args::global().getInt("NThread",1);
+
+    //Look up which pairs of blocks to contract,
+    //reusing the result for repeated block structures
+    auto& cache = blockPlanCache();
+    auto key = blockPlanKey(Con,Lind,Rind,A,B,C);
+    auto* pplan = cache.find(key);
+    if(!pplan)
+        {
+        PROFILE_SCOPE("blockplan")
+        auto plan = makeBlockContractPlan(A,Con.Lis,B,Con.Ris,C,Con.Nis);
+        batchBlockGemms(plan,Con,Lind,Rind,Cind);
+        pplan = &cache.insert(std::move(key),std::move(plan));
+        }
+    auto& plan = *pplan;
+
+    //Contract entry n of the plan, either as a single
+    //matrix product (if batched) or by calling contract
+    auto contractEntry = [&plan,&A,&B,&C,&do_contract](long n)
+        {
+        auto& e = plan.entries[n];
+        if(plan.batchOf[n] < 0)
+            {
+            do_contract(makeDataRange(A.data(),e.aoffset,A.size()),e.Ablockind,
+                        makeDataRange(B.data(),e.boffset,B.size()),e.Bblockind,
+                        makeDataRange(C.data(),e.coffset,C.size()),e.Cblockind);
+            return;
+            }
+        auto& batch = plan.batches[plan.batchOf[n]];
+        VA const* pa = A.data()+e.aoffset;
+        VB const* pb = B.data()+e.boffset;
+        VC * pc = C.data()+e.coffset;
+        if(batch.swapAB) gemmBatch(batch.shape,&pb,&pa,&pc,1,1.,1.);
+        else             gemmBatch(batch.shape,&pa,&pb,&pc,1,1.,1.);
+        };
+
+    if(nthread > 1)
+        {
+        //Entries of the plan are grouped by their
+        //destination block of C so that no two 
+        //threads write to the same block
+        threadPool(nthread).run(plan.ngroup(),
+            [&plan,&contractEntry](long g)
+            {
+            for(auto n = plan.gstart[g]; n < plan.gstart[g+1]; ++n) contractEntry(n);
+            },nthread);
+        }
+    else
+        {
+        //Small products of the same shape are done
+        //together by gemmBatch, avoiding the overhead
+        //of calling contract (and BLAS) for each one
+        auto pa = vector<VA const*>{};
+        auto pb = vector<VB const*>{};
+        auto pc = vector<VC *>{};
+        for(auto& batch : plan.batches)
+            {
+            pa.clear();
+            pb.clear();
+            pc.clear();
+            for(auto n : batch.entries)
+                {
+                auto& e = plan.entries[n];
+                pa.push_back(A.data()+e.aoffset);
+                pb.push_back(B.data()+e.boffset);
+                pc.push_back(C.data()+e.coffset);
+                }
+            if(batch.swapAB) gemmBatch(batch.shape,pb.data(),pa.data(),pc.data(),pc.size(),1.,1.);
+            else             gemmBatch(batch.shape,pa.data(),pb.data(),pc.data(),pc.size(),1.,1.);
+            }
+        for(auto n : range(plan.entries))
+            {
+            if(plan.batchOf[n] < 0) contractEntry(n);
+            }
+        }
 
 #ifdef USESCALE
-    START_TIMER(21)
     Con.scalefac = computeScalefac(C);
-    STOP_TIMER(21)
 #endif
     }
 template void doTask(Contract& Con,QDense<Real> const&,QDense<Real> const&,ManageStore&);
@@ -630,6 +846,74 @@ template void doTask(NCProd&,QDense<Cplx> const&,QDense<Real> const&,ManageStore
 template void doTask(NCProd&,QDense<Real> const&,QDense<Cplx> const&,ManageStore&);
 template void doTask(NCProd&,QDense<Cplx> const&,QDense<Cplx> const&,ManageStore&);
 
+template<typename VA, typename VB>
+void
+doTask(NCProd& P,
+       QDense<VA> const& A,
+       Dense<VB> const& B,
+       ManageStore& m)
+    {
+    using VC = common_type<VA,VB>;
+    auto& Ais = P.Lis;
+    auto& Bis = P.Ris;
+    auto r = order(Ais);
+    if(order(Bis) != r) Error("QDense*Dense non-contracting product requires the same indices");
+
+    //Stride in B of each index of A
+    auto Bstride = std::vector<long>(r,0);
+    for(auto ia : range(r))
+        {
+        long stride = 1;
+        auto found = false;
+        for(auto ib : range(r))
+            {
+            if(Bis[ib] == Ais[ia])
+                {
+                Bstride[ia] = stride;
+                found = true;
+                break;
+                }
+            stride *= dim(Bis[ib]);
+            }
+        if(!found) Error("QDense*Dense non-contracting product requires the same indices");
+        }
+    P.Nis = Ais;
+
+    auto& C = *m.makeNewData<QDense<VC>>(A.offsets,A.size());
+    auto *pa = A.data();
+    auto *pb = B.data();
+    auto *pc = C.data();
+    IntArray block(r,0);
+    detail::GCounter G(r);
+    for(auto& io : A.offsets)
+        {
+        computeBlockInd(io.block,Ais,block);
+        for(auto j : range(r))
+            {
+            long start = 0;
+            for(auto b : range(block[j]))
+                {
+                start += Ais[j].blocksize0(b);
+                }
+            G.setRange(j,start,start+Ais[j].blocksize0(block[j])-1);
+            }
+        for(; G.notDone(); ++G)
+            {
+            long boff = 0;
+            for(auto j : range(r)) boff += G.i[j]*Bstride[j];
+            pc[io.offset+G.ind] = pa[io.offset+G.ind]*pb[boff];
+            }
+        }
+
+#ifdef USESCALE
+    P.scalefac = computeScalefac(C);
+#endif
+    }
+template void doTask(NCProd&,QDense<Real> const&,Dense<Real> const&,ManageStore&);
+template void doTask(NCProd&,QDense<Cplx> const&,Dense<Real> const&,ManageStore&);
+template void doTask(NCProd&,QDense<Real> const&,Dense<Cplx> const&,ManageStore&);
+template void doTask(NCProd&,QDense<Cplx> const&,Dense<Cplx> const&,ManageStore&);
+
 template<typename T>
 void
 permuteQDense(Permutation  const& P,
@@ -733,5 +1017,64 @@ doTask(RemoveQNs & R,
 template void doTask(RemoveQNs &, QDense<Real> const&, ManageStore &);
 template void doTask(RemoveQNs &, QDense<Cplx> const&, ManageStore &);
 
+template<typename V>
+void
+doTask(TieDiag const& T,
+       QDense<V> const& d,
+       ManageStore & m)
+    {
+    auto& is = T.is;
+    auto r = order(is);
+    //Strides of the result, which has every index but is[i2]
+    auto nstride = std::vector<long>(r,0);
+    long ndim = 1;
+    for(auto j : range(r))
+        {
+        if(j == T.i2) continue;
+        nstride[j] = ndim;
+        ndim *= dim(is[j]);
+        }
+    auto *nd = m.makeNewData<Dense<V>>(ndim,0);
+    auto *pd = d.data();
+    auto *pn = nd->data();
+    IntArray block(r,0);
+    auto start = std::vector<long>(r,0);
+    auto bstride = std::vector<long>(r,0);
+    detail::GCounter C(r);
+    for(auto& io : d.offsets)
+        {
+        computeBlockInd(io.block,is,block);
+        //Only blocks diagonal in (i1,i2) contribute
+        if(block[T.i1] != block[T.i2]) continue;
+        long bs = 1;
+        for(auto j : range(r))
+            {
+            start[j] = 0;
+            for(auto b : range(block[j]))
+                {
+                start[j] += is[j].blocksize0(b);
+                }
+            bstride[j] = bs;
+            bs *= is[j].blocksize0(block[j]);
+            if(j == T.i2) C.setRange(j,0,0);
+            else          C.setRange(j,start[j],start[j]+is[j].blocksize0(block[j])-1);
+            }
+        for(; C.notDone(); ++C)
+            {
+            long boff = (C.i[T.i1]-start[T.i1])*bstride[T.i2],
+                 noff = 0;
+            for(auto j : range(r))
+                {
+                if(j == T.i2) continue;
+                boff += (C.i[j]-start[j])*bstride[j];
+                noff += C.i[j]*nstride[j];
+                }
+            pn[noff] = pd[io.offset+boff];
+            }
+        }
+    }
+template void doTask(TieDiag const&, QDense<Real> const&, ManageStore &);
+template void doTask(TieDiag const&, QDense<Cplx> const&, ManageStore &);
+
 } //namespace itensor
 
@@ -339,6 +339,16 @@ doTask(NCProd& P,
        QDense<VB> const& B,
        ManageStore& m);
 
+//Non-contracting product of A with a Dense B having
+//the same indices as A (in any order); the result
+//has the blocks of A
+template<typename VA, typename VB>
+void
+doTask(NCProd& P,
+       QDense<VA> const& A,
+       Dense<VB> const& B,
+       ManageStore& m);
+
 
 
 // Does a binary search over offsets to see 
@@ -444,6 +454,12 @@ doTask(RemoveQNs & T,
        QDense<V> const& d,
        ManageStore & m);
 
+template<typename V>
+void
+doTask(TieDiag const& T,
+       QDense<V> const& d,
+       ManageStore & m);
+
 
 } //namespace itensor
 
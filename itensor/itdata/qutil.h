@@ -16,7 +16,9 @@
 #ifndef __ITENSOR_QUTIL_H
 #define __ITENSOR_QUTIL_H
 
+#include <list>
 #include "itensor/indexset.h"
+#include "itensor/tensor/gemmbatch.h"
 
 namespace itensor {
 
@@ -159,11 +161,12 @@ loopContractedBlocks(BlockSparseA const& A,
     //Loop over blocks of A (labeled by elements of A.offsets)
     for(auto& aio : A.offsets)
         {
-        TIMER_START(19)
         //Reconstruct indices labeling this block of A, put into Ablock
         //TODO: optimize away need to call computeBlockInd by
         //      storing block indices directly in QDense
         //      Taking 10% of running time in S=1 N=100 DMRG tests (maxdim=100)
+        //      (Contract avoids repeating this work by caching a 
+        //      BlockContractPlan, see below)
         computeBlockInd(aio.block,Ais,Ablockind);
         //Reset couB to run over indices of B (at first)
         couB.reset();
@@ -179,12 +182,9 @@ loopContractedBlocks(BlockSparseA const& A,
             //Begin computing elements of Cblock(=destination of this block-block contraction)
             if(AtoC[iA] != -1) Cblockind[AtoC[iA]] = ival;
             }
-        TIMER_STOP(19)
         //Loop over blocks of B which contract with current block of A
         for(;couB.notDone(); ++couB)
             {
-            TIMER_START(19)
-            //START_TIMER(33)
             //Check whether B contains non-zero block for this setting of couB
             //TODO: check whether block is present by storing all blocks
             //      but most have null pointers to data
@@ -203,7 +203,6 @@ loopContractedBlocks(BlockSparseA const& A,
             assert(cblock);
 
             auto ablock = makeDataRange(A.data(),aio.offset,A.size());
-            TIMER_STOP(19)
 
             callback(ablock,Ablockind,
                      bblock,Bblockind,
@@ -214,6 +213,150 @@ loopContractedBlocks(BlockSparseA const& A,
     }
 
 
+//
+// BlockContractPlan records which blocks of A and B
+// are contracted into which block of C, as found by
+// loopContractedBlocks, so that contractions having
+// the same block structure can skip the block matching.
+//
+// Entries are ordered by the offset of the C block
+// (keeping the original order for the same C block)
+// and group(g) gives the entries in [gstart[g],gstart[g+1])
+// which all write to the same block of C.
+//
+// Entries which are small matrix products can also
+// be collected into batches having the same GemmShape,
+// where each entry of a batch writes to a different
+// block of C; batchOf[n] is the batch holding entry n
+// (or -1). Batches are filled in by the caller
+// since they depend on the contraction being done.
+//
+struct BlockContractPlan
+    {
+    struct Entry
+        {
+        long aoffset = 0,
+             boffset = 0,
+             coffset = 0;
+        Labels Ablockind,
+               Bblockind,
+               Cblockind;
+        };
+    struct Batch
+        {
+        GemmShape shape;
+        //If true, the first factor is the block of B
+        bool swapAB = false;
+        std::vector<long> entries;
+        };
+    std::vector<Entry> entries;
+    std::vector<size_t> gstart;
+    std::vector<Batch> batches;
+    std::vector<long> batchOf;
+
+    long
+    ngroup() const { return gstart.empty() ? 0 : long(gstart.size())-1; }
+    };
+
+template<typename BlockSparseA, 
+         typename BlockSparseB,
+         typename BlockSparseC>
+BlockContractPlan
+makeBlockContractPlan(BlockSparseA const& A,
+                      IndexSet const& Ais,
+                      BlockSparseB const& B,
+                      IndexSet const& Bis,
+                      BlockSparseC & C,
+                      IndexSet const& Cis)
+    {
+    using EntryT = BlockContractPlan::Entry;
+    auto plan = BlockContractPlan{};
+    auto& entries = plan.entries;
+    auto record = [&entries,&A,&B,&C](auto ablock, Labels const& Ablockind,
+                                      auto bblock, Labels const& Bblockind,
+                                      auto cblock, Labels const& Cblockind)
+        {
+        auto e = EntryT{};
+        e.aoffset = ablock.data()-A.data();
+        e.boffset = bblock.data()-B.data();
+        e.coffset = cblock.data()-C.data();
+        e.Ablockind = Ablockind;
+        e.Bblockind = Bblockind;
+        e.Cblockind = Cblockind;
+        entries.push_back(std::move(e));
+        };
+    loopContractedBlocks(A,Ais,B,Bis,C,Cis,record);
+
+    std::stable_sort(entries.begin(),entries.end(),
+                     [](EntryT const& e1, EntryT const& e2) 
+                     { return e1.coffset < e2.coffset; });
+    for(auto n : range(entries))
+        {
+        if(n == 0 || entries[n].coffset != entries[n-1].coffset)
+            {
+            plan.gstart.push_back(n);
+            }
+        }
+    plan.gstart.push_back(entries.size());
+    return plan;
+    }
+
+//
+// Least-recently-used cache of BlockContractPlans.
+// The key should hold everything the plan depends on:
+// the contraction labels, the block structure of
+// each IndexSet and the block offsets of A, B and C.
+//
+class BlockPlanCache
+    {
+    public:
+    using key_type = std::vector<long>;
+    private:
+    struct Item
+        {
+        size_t hash = 0;
+        key_type key;
+        BlockContractPlan plan;
+        };
+    std::list<Item> items_;
+    size_t maxsize_ = 200;
+    long hits_ = 0,
+         misses_ = 0;
+    public:
+
+    BlockPlanCache() { }
+
+    //Returns nullptr if no plan stored for key
+    BlockContractPlan const*
+    find(key_type const& key);
+
+    BlockContractPlan const&
+    insert(key_type && key, BlockContractPlan && plan);
+
+    void
+    clear() { items_.clear(); }
+
+    size_t
+    size() const { return items_.size(); }
+
+    size_t
+    maxSize() const { return maxsize_; }
+
+    //Setting maxsize to zero turns off caching
+    void
+    setMaxSize(size_t maxsize);
+
+    long
+    hits() const { return hits_; }
+
+    long
+    misses() const { return misses_; }
+    };
+
+//Cache used by QDense contractions on the calling thread
+BlockPlanCache&
+blockPlanCache();
+
 } //namespace itensor
 
 #endif
@@ -558,6 +558,23 @@ struct RemoveQNs
 inline const char*
 typeNameOf(RemoveQNs) { return "RemoveQNs";}
 
+//Diagonal of a tensor over the index pair
+//(is[i1],is[i2]), as Dense storage over the
+//other indices of is (in order, dropping is[i2])
+struct TieDiag
+    {
+    IndexSet const& is;
+    long i1 = 0,
+         i2 = 0;
+    TieDiag(IndexSet const& is_,
+            long i1_,
+            long i2_)
+      : is(is_), i1(i1_), i2(i2_) {}
+    };
+
+inline const char*
+typeNameOf(TieDiag) { return "TieDiag";}
+
 } //namespace itensor 
 
 #endif
@@ -29,6 +29,13 @@ namespace itensor {
 // Returns the minimal eigenvalue lambda such that
 // A phi = lambda phi.
 //
+// Passing "Precondition" = true applies the Davidson
+// (diagonal) preconditioner to each residual q, i.e.
+// q(i) -> q(i)/(lambda-A(i,i)), using A.diag() computed
+// once per call. This needs fewer products when A is
+// dominated by its diagonal (such as Hubbard models
+// at large U).
+//
 template <class BigMatrixT>
 Real 
 davidson(BigMatrixT const& A, 
@@ -49,6 +56,33 @@ davidson(BigMatrixT const& A,
          std::vector<ITensor>& phi,
          Args const& args = Args::global());
 
+//
+// Block Davidson with thick restart: like the
+// previous davidson, finds the N eigenvectors of
+// the Hermitian matrix A with smallest eigenvalues
+// given N initial guesses phi, but each iteration
+// adds the residuals of all unconverged vectors to
+// the subspace at once. If BigMatrixT has a method
+//   product(std::vector<ITensor> const& x,
+//           std::vector<ITensor> & Ax)
+// (as LocalMPO does) it is called on these blocks,
+// otherwise product is called on each vector.
+//
+// Args:
+// o "MaxIter" - number of block iterations (default 2)
+// o "MaxSubspace" - if adding a block would make the
+//   subspace larger than this, it is first restarted
+//   from the lowest Ritz vectors, keeping at least N
+//   (default 0: no limit other than MaxIter)
+// o "ErrGoal", "MinIter", "DebugLevel" and "Precondition"
+//   as for davidson
+//
+template <class BigMatrixT>
+std::vector<Real>
+blockDavidson(BigMatrixT const& A,
+              std::vector<ITensor>& phi,
+              Args const& args = Args::global());
+
 //
 // Use GMRES to iteratively solve A x = b for x.
 // (BigMatrixT objects must implement the methods product and size.)
@@ -61,12 +95,71 @@ gmres(BigMatrixT const& A,
       ITensor& x,
       Args const& args = Args::global());
 
+//
+// Use the Lanczos method to set phi to exp(t*A)*phi
+// for the Hermitian matrix A and a real or complex
+// number t (t = -i*dt for real time evolution, t = -dt
+// for imaginary time evolution), without needing A
+// itself. exp(t*A) is computed exactly within the
+// Krylov subspace spanned by phi, A*phi, A^2*phi, ...
+// (BigMatrixT objects must implement the method product.)
+// Returns <phi|A|phi>/<phi|phi> of the input phi.
+//
+// Args:
+// o "MaxIter" - maximum dimension of the Krylov
+//   subspace (default 30)
+// o "ErrGoal" - stop enlarging the subspace once the
+//   estimated error of exp(t*A)*phi is below
+//   ErrGoal*norm(phi) (default 1E-12)
+// o "DebugLevel"
+//
+template<typename BigMatrixT>
+Real
+applyExp(BigMatrixT const& A,
+         ITensor & phi,
+         Cplx t,
+         Args const& args = Args::global());
+
 //
 //
 // Implementations
 //
 //
 
+namespace detail {
+
+template<typename BigMatrixT>
+auto
+diagOf(stdx::choice<1>,
+       BigMatrixT const& A)
+    -> stdx::if_compiles_return<ITensor,decltype(A.diag())>
+    {
+    return A.diag();
+    }
+
+template<typename BigMatrixT>
+ITensor
+diagOf(stdx::choice<2>,
+       BigMatrixT const& A)
+    {
+    Error("Precondition requires the method diag of BigMatrixT");
+    return ITensor();
+    }
+
+//Davidson preconditioner: q(i) -> q(i)/(lambda-Adiag(i))
+//(Adiag has no QNs if A does, see LocalOp::diag)
+void inline
+precondition(ITensor & q,
+             ITensor const& Adiag,
+             Real lambda)
+    {
+    auto cond = Adiag;
+    cond.apply([lambda](Real d) { return (lambda == d) ? 0. : 1./(lambda-d); });
+    q /= cond;
+    }
+
+} //namespace detail
+
 
 template <class BigMatrixT>
 Real
@@ -87,6 +180,7 @@ davidson(BigMatrixT const& A,
          std::vector<ITensor>& phi,
          Args const& args)
     {
+    PROFILE_SCOPE("davidson")
     auto maxiter_ = args.getSizeT("MaxIter",2);
     auto errgoal_ = args.getReal("ErrGoal",1E-14);
     auto debug_level_ = args.getInt("DebugLevel",-1);
@@ -135,8 +229,9 @@ davidson(BigMatrixT const& A,
     //Mref holds current projection of A into V's
     auto Mref = subMatrix(M,0,1,0,1);
 
-    //Get diagonal of A to use later
-    //auto Adiag = A.diag();
+    //Diagonal of A for the preconditioner
+    auto Adiag = args.getBool("Precondition",false) ? detail::diagOf(stdx::select_overload{},A)
+                                                    : ITensor();
 
     Real qnorm = NAN;
 
@@ -189,7 +284,7 @@ davidson(BigMatrixT const& A,
             lambda = D(t);
             phi_t = U(0,t)*V[0];
             q     = U(0,t)*AV[0];
-            for(auto k : range(ii+1))
+            for(auto k : range1(ii))
                 {
                 phi_t += U(k,t)*V[k];
                 q     += U(k,t)*AV[k];
@@ -264,27 +359,18 @@ davidson(BigMatrixT const& A,
         //Step D of Davidson (1975)
         //Apply Davidson preconditioner
 
-        //
-        //TODO add preconditioner step (may require
-        //non-contracting product to do efficiently)
-        //
-        //if(Adiag)
-        //    {
-        //    //Function which applies the mapping
-        //    // f(x,theta) = 1/(theta - x)
-        //    auto precond = [theta=lambda.real()](Real val)
-        //        {
-        //        return (theta==val) ? 0 : 1./(theta-val);
-        //        };
-        //    auto cond= Adiag;
-        //    cond.apply(precond);
-        //    q /= cond;
-        //    }
+        if(Adiag)
+            {
+            detail::precondition(q,Adiag,lambda);
+            q /= norm(q);
+            }
 
         //Step E and F of Davidson (1975)
         //Do Gram-Schmidt on d (Npass times)
         //to include it in the subbasis
-        int Npass = 1;
+        //(a preconditioned q can be nearly parallel
+        //to phi_t, so orthogonalize it twice)
+        int Npass = Adiag ? 2 : 1;
         auto Vq = std::vector<Cplx>(ni);
         int pass = 1;
         int tot_pass = 0;
@@ -439,6 +525,271 @@ davidson(BigMatrixT const& A,
     return eigs;
     }
 
+namespace detail {
+
+template<typename BigMatrixT>
+auto
+blockProduct(stdx::choice<1>,
+             BigMatrixT const& A,
+             std::vector<ITensor> const& x,
+             std::vector<ITensor> & Ax)
+    -> stdx::if_compiles_return<void,decltype(A.product(x,Ax))>
+    {
+    A.product(x,Ax);
+    }
+
+template<typename BigMatrixT>
+void
+blockProduct(stdx::choice<2>,
+             BigMatrixT const& A,
+             std::vector<ITensor> const& x,
+             std::vector<ITensor> & Ax)
+    {
+    Ax.resize(x.size());
+    for(auto n : range(x)) A.product(x[n],Ax[n]);
+    }
+
+//Set res = sum_k U(k,j)*V[k] (k < n), adding
+//each term into the storage of res
+void inline
+combineBasis(ITensor & res,
+             std::vector<ITensor> const& V,
+             CMatrix const& U,
+             size_t j,
+             size_t n)
+    {
+    res = U(0,j)*V[0];
+    for(auto k : range(1ul,n)) res += U(k,j)*V[k];
+    }
+
+//Orthogonalize q against V[0],...,V[n-1] (two
+//Gram-Schmidt passes); returns the ratio of the
+//norm of q after and before
+Real inline
+orthogonalizeTo(ITensor & q,
+                std::vector<ITensor> const& V,
+                size_t n)
+    {
+    auto nrm0 = norm(q);
+    if(nrm0 == 0.) return 0.;
+    for(int pass = 0; pass < 2; ++pass)
+    for(auto k : range(n))
+        {
+        q -= (dag(V[k])*q).eltC()*V[k];
+        }
+    return norm(q)/nrm0;
+    }
+
+} //namespace detail
+
+template <class BigMatrixT>
+std::vector<Real>
+blockDavidson(BigMatrixT const& A,
+              std::vector<ITensor>& phi,
+              Args const& args)
+    {
+    PROFILE_SCOPE("blockDavidson")
+    auto maxiter = args.getSizeT("MaxIter",2);
+    auto errgoal = args.getReal("ErrGoal",1E-14);
+    auto debug_level = args.getInt("DebugLevel",-1);
+    auto miniter = args.getSizeT("MinIter",1);
+
+    Real Approx0 = 1E-12;
+    //Vectors losing more than this fraction of their
+    //norm to orthogonalization are taken as dependent
+    Real DepTol = 1E-10;
+
+    auto nget = phi.size();
+    if(nget == 0) Error("No initial vectors passed to blockDavidson.");
+
+    auto maxsize = size_t(A.size());
+    if(size_t(dim(inds(phi.front()))) != maxsize)
+        {
+        println("dim(inds(phi.front())) = ",dim(inds(phi.front())));
+        println("A.size() = ",A.size());
+        Error("blockDavidson: size of initial vector should match linear matrix size");
+        }
+    if(nget > maxsize) Error("blockDavidson: more vectors requested than the size of A");
+
+    auto maxsub = args.getSizeT("MaxSubspace",0);
+    if(maxsub == 0) maxsub = nget*(maxiter+2);
+    maxsub = std::min(maxsub,maxsize);
+    if(maxsub <= nget && maxsize > nget)
+        {
+        Error("blockDavidson: MaxSubspace must be larger than the number of vectors");
+        }
+
+    auto Adiag = args.getBool("Precondition",false) ? detail::diagOf(stdx::select_overload{},A)
+                                                    : ITensor();
+
+    //Basis V of the subspace and AV = A*V
+    auto V = std::vector<ITensor>{};
+    auto AV = std::vector<ITensor>{};
+    V.reserve(maxsub);
+    AV.reserve(maxsub);
+
+    //Start from the orthonormalized guesses
+    for(auto j : range(nget))
+        {
+        auto q = phi[j];
+        if(norm(q) == 0.) q.randomize();
+        auto tries = 0;
+        while(detail::orthogonalizeTo(q,V,V.size()) < DepTol)
+            {
+            if(++tries > 3) Error("blockDavidson: could not make independent initial vectors");
+            q.randomize();
+            }
+        q /= norm(q);
+        V.push_back(q);
+        }
+    detail::blockProduct(stdx::select_overload{},A,V,AV);
+
+    //Storage for Matrix that gets diagonalized
+    //set to NAN to ensure failure if we use uninitialized elements
+    auto M = CMatrix(maxsub,maxsub);
+    for(auto& el : M) el = Cplx(NAN,NAN);
+    auto fillM = [&M,&V,&AV](size_t n0, size_t n)
+        {
+        for(auto k : range(n0,n))
+        for(auto j : range(k+1))
+            {
+            auto z = (dag(V[j])*AV[k]).eltC();
+            M(j,k) = z;
+            M(k,j) = std::conj(z);
+            }
+        };
+    fillM(0,nget);
+
+    auto eigs = std::vector<Real>(nget,NAN);
+    auto last_eigs = std::vector<Real>(nget,1000.);
+    auto qnorms = std::vector<Real>(nget,NAN);
+    //Residuals of the Ritz vectors
+    auto Q = std::vector<ITensor>(nget);
+
+    CMatrix U;
+    Vector D;
+
+    auto iter = size_t(0);
+    auto printEigs = [&]()
+        {
+        printf("I %d q %.0E E",iter,*std::max_element(qnorms.begin(),qnorms.end()));
+        for(auto eig : eigs) printf(" %.10f",eig);
+        println();
+        };
+
+    while(true)
+        {
+        //Diagonalize dag(V)*A*V, giving the Ritz
+        //vectors phi and their residuals Q
+        auto n = V.size();
+        auto Mref = subMatrix(M,0,n,0,n);
+        Mref *= -1;
+        diagHermitian(Mref,U,D);
+        Mref *= -1;
+        D *= -1;
+
+        auto unconverged = std::vector<size_t>{};
+        for(auto j : range(nget))
+            {
+            eigs[j] = D(j);
+            detail::combineBasis(phi[j],V,U,j,n);
+            detail::combineBasis(Q[j],AV,U,j,n);
+            Q[j] -= eigs[j]*phi[j];
+            qnorms[j] = norm(Q[j]);
+            bool converged = (qnorms[j] < errgoal && std::abs(eigs[j]-last_eigs[j]) < errgoal)
+                             || qnorms[j] < std::max(Approx0,errgoal * 1E-3);
+            last_eigs[j] = eigs[j];
+            if(!converged) unconverged.push_back(j);
+            }
+
+        if(debug_level >= 2 || (iter == 0 && debug_level >= 1)) printEigs();
+
+        if(unconverged.empty() && iter < miniter)
+            {
+            for(auto j : range(nget)) if(qnorms[j] > 1E-20) unconverged.push_back(j);
+            }
+        if(unconverged.empty() || iter == maxiter || n == maxsize)
+            {
+            if(debug_level >= 3)
+                {
+                if(unconverged.empty()) println("Exiting blockDavidson because all vectors converged");
+                else if(iter == maxiter) println("Exiting blockDavidson because iter == maxiter");
+                else                     println("Exiting blockDavidson: max Hilbert space size reached");
+                }
+            break;
+            }
+
+        //Thick restart: keep the lowest Ritz vectors
+        //so the new block fits within maxsub
+        auto nadd = std::min(unconverged.size(),maxsub-nget);
+        if(n+nadd > maxsub)
+            {
+            auto nkeep = maxsub-nadd;
+            auto nV = std::vector<ITensor>(nkeep);
+            auto nAV = std::vector<ITensor>(nkeep);
+            for(auto j : range(nkeep))
+                {
+                if(j < nget)
+                    {
+                    nV[j] = phi[j];
+                    nAV[j] = Q[j] + eigs[j]*phi[j];
+                    }
+                else
+                    {
+                    detail::combineBasis(nV[j],V,U,j,n);
+                    detail::combineBasis(nAV[j],AV,U,j,n);
+                    }
+                }
+            V = std::move(nV);
+            AV = std::move(nAV);
+            V.reserve(maxsub);
+            AV.reserve(maxsub);
+            for(auto j : range(nkeep))
+            for(auto k : range(nkeep))
+                {
+                M(j,k) = (j == k) ? Cplx(D(j)) : Cplx(0.);
+                }
+            n = nkeep;
+            if(debug_level >= 2) printfln("Restarting blockDavidson with %d vectors",nkeep);
+            }
+
+        //Add the residuals to the basis,
+        //dropping any that are not independent
+        for(auto j : range(nadd))
+            {
+            auto q = Q[unconverged[j]];
+            if(Adiag)
+                {
+                detail::precondition(q,Adiag,eigs[unconverged[j]]);
+                q /= norm(q);
+                }
+            if(detail::orthogonalizeTo(q,V,V.size()) < DepTol) continue;
+            q /= norm(q);
+            q.scaleTo(1.);
+            V.push_back(q);
+            }
+        if(V.size() == n)
+            {
+            if(debug_level >= 3) println("Exiting blockDavidson: no independent residuals");
+            break;
+            }
+
+        auto Vnew = std::vector<ITensor>(V.begin()+n,V.end());
+        auto AVnew = std::vector<ITensor>{};
+        detail::blockProduct(stdx::select_overload{},A,Vnew,AVnew);
+        for(auto& T : AVnew) AV.push_back(std::move(T));
+        fillM(n,V.size());
+
+        ++iter;
+        }
+
+    for(auto& phi_j : phi) phi_j /= norm(phi_j);
+
+    if(debug_level > 0) printEigs();
+
+    return eigs;
+    }
+
 namespace gmres_details {
 
 template<class Matrix, class T>
@@ -654,6 +1005,89 @@ gmres(BigMatrixT const& A,
         }
     }
 
+template<typename BigMatrixT>
+Real
+applyExp(BigMatrixT const& A,
+         ITensor & phi,
+         Cplx t,
+         Args const& args)
+    {
+    PROFILE_SCOPE("applyExp")
+    auto maxiter = args.getInt("MaxIter",30);
+    auto errgoal = args.getReal("ErrGoal",1E-12);
+    auto debug_level = args.getInt("DebugLevel",-1);
+    if(maxiter < 1) Error("applyExp: MaxIter must be at least 1");
+
+    auto nrm = norm(phi);
+    if(nrm == 0.) return 0.;
+
+    //Lanczos vectors V, with dag(V)*A*V the tridiagonal
+    //matrix with alpha on the diagonal and beta next to it
+    auto V = std::vector<ITensor>{phi/nrm};
+    auto alpha = std::vector<Real>{};
+    auto beta = std::vector<Real>{};
+
+    //Coefficients of exp(t*A)*phi/nrm in V
+    auto c = CVector{};
+
+    for(auto k : range(maxiter))
+        {
+        ITensor w;
+        A.product(V[k],w);
+        alpha.push_back(eltC(dag(V[k])*w).real());
+        w -= alpha[k]*V[k];
+        if(k > 0) w -= beta[k-1]*V[k-1];
+        //Lanczos vectors lose orthogonality
+        //quickly, so reorthogonalize against all
+        for(auto& v : V) w -= eltC(dag(v)*w)*v;
+        auto b = norm(w);
+
+        //Exponentiate the tridiagonal matrix
+        auto n = k+1;
+        auto T = Matrix(n,n);
+        for(auto i : range(n))
+            {
+            T(i,i) = alpha[i];
+            if(i+1 < n) T(i,i+1) = T(i+1,i) = beta[i];
+            }
+        Matrix U;
+        Vector D;
+        diagHermitian(T,U,D);
+        c = CVector(n);
+        for(auto i : range(n))
+            {
+            c(i) = 0.;
+            for(auto j : range(n)) c(i) += U(i,j)*std::exp(t*D(j))*U(0,j);
+            }
+
+        //Error estimate: norm of the part of
+        //A*V*c that falls outside the subspace
+        auto err = b*std::abs(c(k));
+        if(debug_level >= 2) printfln("applyExp: k = %d, err = %.3E",k,err);
+        if(err < errgoal || b < 1E-14 || k+1 == maxiter)
+            {
+            if(debug_level >= 1 && err >= errgoal && b >= 1E-14)
+                {
+                printfln("applyExp: error %.3E above ErrGoal after %d Krylov vectors",err,n);
+                }
+            break;
+            }
+        beta.push_back(b);
+        V.push_back(w/b);
+        }
+
+    //Keep phi real if t and A are real
+    auto is_real = (t.imag() == 0.) && !isComplex(phi);
+    for(auto& v : V) is_real = is_real && !isComplex(v);
+    phi = ITensor{};
+    for(auto i : range(V.size()))
+        {
+        if(is_real) phi += (nrm*c(i).real())*V[i];
+        else        phi += (nrm*c(i))*V[i];
+        }
+    return alpha.front();
+    }
+
 } //namespace itensor
 
 #endif
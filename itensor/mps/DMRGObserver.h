@@ -18,6 +18,8 @@
 #include "itensor/mps/mps.h"
 #include "itensor/mps/observer.h"
 #include "itensor/spectrum.h"
+#include "itensor/util/counters.h"
+#include "itensor/util/cputime.h"
 
 namespace itensor {
 
@@ -27,6 +29,13 @@ namespace itensor {
 // so that behavior can be customized in a
 // derived class.
 //
+// Each call to measure records the flops counted
+// by opCounts() (see util/counters.h) and the wall
+// time since the previous call, so an overload of
+// measure can log them for each bond via bondFlops(),
+// bondTime() and liveBytes().
+// Set "PrintFlops" to true to print them.
+//
 
 class DMRGObserver : public Observer
     {
@@ -52,6 +61,32 @@ class DMRGObserver : public Observer
     Spectrum const&
     spectrum() const { return last_spec_; }
 
+    //Number of products with the local Hamiltonian
+    //(summed over the "DavidsonProducts" args passed
+    //to measure) during the last complete sweep
+    long
+    sweepProducts() const { return sweep_products_; }
+
+    //Flops and wall time (in seconds) since
+    //the previous call to measure
+    Real
+    bondFlops() const { return bond_flops_; }
+
+    Real
+    bondTime() const { return bond_time_; }
+
+    //Bytes of tensor storage alive
+    //when measure was last called
+    Real
+    liveBytes() const { return live_bytes_; }
+
+    //Flops and wall time of the last complete sweep
+    Real
+    sweepFlops() const { return sweep_flops_; }
+
+    Real
+    sweepTime() const { return sweep_time_; }
+
     private:
 
     /////////////
@@ -64,6 +99,18 @@ class DMRGObserver : public Observer
     bool done_;
     Real last_energy_;
     Spectrum last_spec_;
+    long nproducts_;
+    long sweep_products_;
+    bool printflops_;
+    OpCounts last_counts_;
+    cpu_time last_time_;
+    Real bond_flops_;
+    Real bond_time_;
+    Real live_bytes_;
+    Real nflops_;
+    Real ntime_;
+    Real sweep_flops_;
+    Real sweep_time_;
 
     /////////////
 
@@ -78,7 +125,18 @@ DMRGObserver(MPS const& psi, Args const& args)
     max_eigs(-1),
     max_te(-1),
     done_(false),
-    last_energy_(1000)
+    last_energy_(1000),
+    nproducts_(0),
+    sweep_products_(0),
+    printflops_(args.getBool("PrintFlops",false)),
+    last_counts_(opCounts()),
+    bond_flops_(0),
+    bond_time_(0),
+    live_bytes_(0),
+    nflops_(0),
+    ntime_(0),
+    sweep_flops_(0),
+    sweep_time_(0)
     //default_ops_(psi.sites().defaultOps())
     { 
     }
@@ -94,6 +152,19 @@ measure(Args const& args)
     auto energy = args.getReal("Energy",0);
     auto silent = args.getBool("Silent",false);
 
+    auto counts = opCounts();
+    bond_flops_ = counts.flops-last_counts_.flops;
+    bond_time_ = last_time_.sincemark().wall;
+    live_bytes_ = counts.live_bytes;
+    nflops_ += bond_flops_;
+    ntime_ += bond_time_;
+    if(printflops_ && !silent)
+        {
+        printfln("    Bond %d: %.3f GFlop in %.3f s (%.2f GFlop/s), tensor memory %.1f MB (peak %.1f MB)",
+                 b,1E-9*bond_flops_,bond_time_,(bond_time_ > 0 ? 1E-9*bond_flops_/bond_time_ : 0.),
+                 live_bytes_/1E6,counts.peak_bytes/1E6);
+        }
+
     if(!args.getBool("Quiet",false) && !args.getBool("NoMeasure",false))
         {
         if(b < N && b > 0)
@@ -145,6 +216,16 @@ measure(Args const& args)
 
     max_eigs = std::max(max_eigs,last_spec_.numEigsKept());
     max_te = std::max(max_te,last_spec_.truncerr());
+    nproducts_ += args.getInt("DavidsonProducts",0);
+    if(b == 1 && ha == 2)
+        {
+        sweep_products_ = nproducts_;
+        nproducts_ = 0;
+        sweep_flops_ = nflops_;
+        sweep_time_ = ntime_;
+        nflops_ = 0;
+        ntime_ = 0;
+        }
     if(!silent)
         {
         if(b == 1 && ha == 2) 
@@ -156,10 +237,21 @@ measure(Args const& args)
             max_eigs = -1;
             println("    Largest truncation error: ",(max_te > 0 ? max_te : 0.));
             max_te = -1;
+            if(sweep_products_ > 0) println("    Davidson products during sweep: ",sweep_products_);
+            if(printflops_)
+                {
+                printfln("    GFlop/s during sweep: %.2f (%.3f GFlop in %.3f s)",
+                         (sweep_time_ > 0 ? 1E-9*sweep_flops_/sweep_time_ : 0.),
+                         1E-9*sweep_flops_,sweep_time_);
+                }
             printfln("    Energy after sweep %s is %.12f",swstr,energy);
             }
         }
 
+    //Start timing the next bond only now,
+    //leaving out the time spent here
+    last_counts_ = opCounts();
+    last_time_.mark();
     }
 
 
@@ -0,0 +1,268 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <fstream>
+#include "itensor/mps/diskcache.h"
+#include "itensor/util/readwrite.h"
+
+namespace itensor {
+
+DiskCache::
+DiskCache(size_t maxBytes)
+  : max_bytes_(maxBytes)
+    {
+    thread_ = std::thread([this]() { runJobs(); });
+    }
+
+DiskCache::
+~DiskCache()
+    {
+        {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        }
+    wake_.notify_all();
+    thread_.join();
+    }
+
+void DiskCache::
+write(std::string const& fname, ITensor T)
+    {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& e = entries_[fname];
+    bytes_ -= e.bytes;
+    e.bytes = 0;
+    e.T = std::move(T);
+    e.dirty = true;
+    e.loading = false;
+    e.pinned = false;
+    ++e.version;
+    touch(fname);
+    jobs_.push_back(Job{fname,true});
+    wake_.notify_one();
+    }
+
+void DiskCache::
+prefetch(std::string const& fname)
+    {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(entries_.count(fname)) return;
+    //Only the latest prefetch is kept if never read
+    for(auto& fe : entries_) fe.second.pinned = false;
+    auto& e = entries_[fname];
+    e.loading = true;
+    e.pinned = true;
+    touch(fname);
+    jobs_.push_back(Job{fname,false});
+    wake_.notify_one();
+    }
+
+ITensor DiskCache::
+read(std::string const& fname)
+    {
+    std::unique_lock<std::mutex> lock(mutex_);
+    rethrow();
+    ++stats_.nread;
+    auto waited = false;
+    while(true)
+        {
+        auto it = entries_.find(fname);
+        if(it == entries_.end()) break;
+        auto& e = it->second;
+        if(e.loading)
+            {
+            waited = true;
+            done_.wait(lock);
+            rethrow();
+            continue;
+            }
+        if(waited) ++stats_.nwait;
+        else       ++stats_.nhit;
+        e.pinned = false;
+        auto T = e.T;
+        touch(fname);
+        evict();
+        return T;
+        }
+
+    //Not in memory (or the prefetch failed):
+    //read fname in the calling thread
+    lock.unlock();
+    std::ifstream s(fname.c_str(),std::ios::binary);
+    if(!s.good())
+        throw ITError("Couldn't open file \"" + fname + "\" for reading");
+    ITensor T;
+    itensor::read(s,T);
+    auto bytes = size_t(s.tellg());
+    lock.lock();
+    if(!entries_.count(fname))
+        {
+        auto& e = entries_[fname];
+        e.T = T;
+        e.bytes = bytes;
+        bytes_ += bytes;
+        touch(fname);
+        evict();
+        }
+    return T;
+    }
+
+void DiskCache::
+flush()
+    {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock,[this]()
+        {
+        for(auto& fe : entries_) if(fe.second.dirty) return false;
+        return true;
+        });
+    rethrow();
+    }
+
+DiskCache::Stats DiskCache::
+stats()
+    {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+    }
+
+void DiskCache::
+runJobs()
+    {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(true)
+        {
+        wake_.wait(lock,[this]() { return stop_ || !jobs_.empty(); });
+        if(jobs_.empty()) return; //stop_ is set
+        auto job = std::move(jobs_.front());
+        jobs_.pop_front();
+        auto it = entries_.find(job.fname);
+        if(job.write)
+            {
+            //Skip if a later job already wrote this file
+            if(it == entries_.end() || !it->second.dirty) continue;
+            auto T = it->second.T;
+            auto version = it->second.version;
+            lock.unlock();
+            size_t bytes = 0;
+            std::exception_ptr err;
+            try
+                {
+                std::ofstream s(job.fname.c_str(),std::ios::binary);
+                if(!s.good())
+                    throw ITError("Couldn't open file \"" + job.fname + "\" for writing");
+                itensor::write(s,T);
+                bytes = size_t(s.tellp());
+                }
+            catch(...)
+                {
+                err = std::current_exception();
+                }
+            lock.lock();
+            ++stats_.nwrite;
+            if(err) error_ = err;
+            it = entries_.find(job.fname);
+            if(it != entries_.end() && it->second.version == version)
+                {
+                it->second.dirty = false;
+                it->second.bytes = bytes;
+                bytes_ += bytes;
+                }
+            }
+        else
+            {
+            if(stop_ || it == entries_.end() || !it->second.loading)
+                {
+                if(it != entries_.end() && it->second.loading)
+                    {
+                    entries_.erase(it);
+                    lru_.remove(job.fname);
+                    }
+                continue;
+                }
+            lock.unlock();
+            ITensor T;
+            size_t bytes = 0;
+            auto ok = false;
+            try
+                {
+                std::ifstream s(job.fname.c_str(),std::ios::binary);
+                if(s.good())
+                    {
+                    itensor::read(s,T);
+                    bytes = size_t(s.tellg());
+                    ok = true;
+                    }
+                }
+            catch(...)
+                {
+                //A failed prefetch is not an error:
+                //read will try again and report it
+                }
+            lock.lock();
+            it = entries_.find(job.fname);
+            if(it != entries_.end() && it->second.loading)
+                {
+                if(ok)
+                    {
+                    it->second.T = std::move(T);
+                    it->second.loading = false;
+                    it->second.bytes = bytes;
+                    bytes_ += bytes;
+                    }
+                else
+                    {
+                    entries_.erase(it);
+                    lru_.remove(job.fname);
+                    }
+                }
+            }
+        evict();
+        done_.notify_all();
+        }
+    }
+
+void DiskCache::
+touch(std::string const& fname)
+    {
+    lru_.remove(fname);
+    lru_.push_front(fname);
+    }
+
+void DiskCache::
+evict()
+    {
+    auto it = lru_.end();
+    while(bytes_ > max_bytes_ && it != lru_.begin())
+        {
+        --it;
+        auto& e = entries_.at(*it);
+        if(e.dirty || e.loading || e.pinned) continue;
+        bytes_ -= e.bytes;
+        entries_.erase(*it);
+        it = lru_.erase(it);
+        }
+    }
+
+void DiskCache::
+rethrow()
+    {
+    if(!error_) return;
+    auto err = error_;
+    error_ = nullptr;
+    std::rethrow_exception(err);
+    }
+
+} //namespace itensor
@@ -0,0 +1,139 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_DISKCACHE_H
+#define __ITENSOR_DISKCACHE_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "itensor/itensor.h"
+
+namespace itensor {
+
+//
+// DiskCache - ITensors stored in files, with the
+// file writes and reads done on a background thread
+//
+// o write(fname,T) returns at once; T is written
+//   to fname behind the caller and stays in memory
+//   until then, so reading fname back never waits.
+// o prefetch(fname) starts reading fname so that
+//   a later read(fname) finds it in memory.
+// o Tensors already written or prefetched and read
+//   are kept, most recently used first, up to a
+//   total of maxBytes (the size of their files).
+//   The most recent prefetch is kept regardless,
+//   until it is read.
+//
+// Errors in the background thread (such as a failed
+// write) are thrown by the next call to read or flush.
+//
+class DiskCache
+    {
+    public:
+
+    struct Stats
+        {
+        long nread = 0,     //calls to read
+             nhit = 0,      //reads found in memory
+             nwait = 0,     //reads waiting for a prefetch
+             nwrite = 0;    //files written
+        };
+
+    private:
+
+    struct Entry
+        {
+        ITensor T;
+        size_t bytes = 0;
+        bool dirty = false,   //not written yet
+             loading = false, //being read
+             pinned = false;  //prefetched, not read yet
+        unsigned long version = 0;
+        };
+    //Background jobs: write or read a file
+    struct Job
+        {
+        std::string fname;
+        bool write = false;
+        };
+
+    std::map<std::string,Entry> entries_;
+    std::list<std::string> lru_; //most recently used first
+    std::deque<Job> jobs_;
+    size_t max_bytes_ = 0,
+           bytes_ = 0;
+    Stats stats_;
+    std::exception_ptr error_;
+    bool stop_ = false;
+    std::mutex mutex_;
+    std::condition_variable wake_,
+                            done_;
+    std::thread thread_;
+
+    public:
+
+    explicit
+    DiskCache(size_t maxBytes = 0);
+
+    DiskCache(DiskCache const&) = delete;
+    DiskCache& operator=(DiskCache const&) = delete;
+
+    //Waits for pending writes
+    ~DiskCache();
+
+    void
+    write(std::string const& fname, ITensor T);
+
+    void
+    prefetch(std::string const& fname);
+
+    ITensor
+    read(std::string const& fname);
+
+    //Wait until all writes are done
+    void
+    flush();
+
+    Stats
+    stats();
+
+    size_t
+    maxBytes() const { return max_bytes_; }
+
+    private:
+
+    void
+    runJobs();
+
+    void
+    touch(std::string const& fname);
+
+    void
+    evict();
+
+    void
+    rethrow();
+    };
+
+} //namespace itensor
+
+#endif
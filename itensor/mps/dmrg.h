@@ -44,6 +44,25 @@ DMRGWorker(MPS & psi,
 //
 // Available DMRG methods:
 //
+// By default each step optimizes two sites.
+// Passing the arg "NumCenter" = 1 selects single-site
+// DMRG instead: each step optimizes one site, then
+// enlarges the bond it moves across with a subspace
+// expansion term weighted by the sweep's noise value,
+// so the noise must be nonzero for the bond dimension
+// to grow (see splitSiteBond below).
+//
+// Passing the arg "MaxSubspace" > 0 solves each step
+// with blockDavidson, restarting whenever the Davidson
+// subspace would exceed MaxSubspace vectors, which
+// caps the eigensolver memory at large bond dimension.
+//
+// Passing "Precondition" = true uses the diagonal of
+// the local Hamiltonian as a Davidson preconditioner
+// (see davidson). The number of products with the
+// local Hamiltonian at each step is passed to the
+// observer as the arg "DavidsonProducts".
+//
 
 //
 //DMRG with an MPO
@@ -303,6 +322,133 @@ dmrg(MPO const& H,
     }
 
 
+//
+// Single-site DMRG step across bond b:
+// phi is the optimized tensor of site b (if dir is
+// Fromleft) or of site b+1 (if dir is Fromright) and
+// becomes the left- (right-) orthogonal tensor of the
+// MPS, with the orthogonality center moved to site b+1 (b).
+//
+// The basis for bond b is chosen from the density matrix
+// of phi plus "Noise" times the subspace expansion term
+// PH.deltaRho, made by applying the left (right) environment
+// and the MPO tensor of the site to phi. This adds states
+// to bond b which a single-site update could not reach
+// on its own; the tensor on the other side of the bond
+// gets zero weight on the added states.
+//
+template<class LocalOpT>
+Spectrum
+splitSiteBond(MPS & psi,
+              int b,
+              ITensor const& phi,
+              Direction dir,
+              LocalOpT const& PH,
+              Args args = Args::global())
+    {
+    // Truncate blocks of degenerate singular values
+    args.add("RespectDegenerate",args.getBool("RespectDegenerate",true));
+
+    // Store the original tags for link b so that it can
+    // be put back onto the newly introduced link index
+    auto original_link_tags = tags(linkIndex(psi,b));
+
+    ITensor A,B;
+    if(dir == Fromleft) A = ITensor(uniqueInds(phi,psi(b+1)));
+    else                B = ITensor(uniqueInds(phi,psi(b)));
+    auto spec = denmatDecomp(phi,A,B,dir,PH,args);
+
+    auto& oc = (dir == Fromleft ? B : A);
+    if(args.getBool("DoNormalize",false))
+        {
+        auto nrm = norm(oc);
+        if(nrm > 1E-16) oc *= 1./nrm;
+        }
+
+    auto lb = commonIndex(A,B);
+    A.setTags(original_link_tags,lb);
+    B.setTags(original_link_tags,lb);
+
+    if(dir == Fromleft)
+        {
+        psi.ref(b) = A;
+        psi.ref(b+1) *= B;
+        psi.leftLim(b);
+        psi.rightLim(b+2);
+        }
+    else
+        {
+        psi.ref(b+1) = B;
+        psi.ref(b) *= A;
+        psi.leftLim(b-1);
+        psi.rightLim(b+1);
+        }
+    return spec;
+    }
+
+namespace detail {
+
+//Wraps a local operator, counting the
+//vectors multiplied by it
+template<class LocalOpT>
+struct CountProducts
+    {
+    LocalOpT const& PH;
+    mutable long count = 0;
+
+    CountProducts(LocalOpT const& PH_) : PH(PH_) { }
+
+    void
+    product(ITensor const& phi, ITensor & phip) const
+        {
+        ++count;
+        PH.product(phi,phip);
+        }
+
+    void
+    product(std::vector<ITensor> const& phi, std::vector<ITensor> & phip) const
+        {
+        count += phi.size();
+        blockProduct(stdx::select_overload{},PH,phi,phip);
+        }
+
+    ITensor
+    diag() const { return PH.diag(); }
+
+    size_t
+    size() const { return PH.size(); }
+    };
+
+} //namespace detail
+
+//
+// Ground state of PH for one DMRG step, by davidson
+// or (if "MaxSubspace" > 0) by blockDavidson;
+// nproduct is set to the number of products with PH
+//
+template<class LocalOpT>
+Real
+DMRGEigensolve(LocalOpT const& PH,
+               ITensor & phi,
+               long & nproduct,
+               Args const& args)
+    {
+    auto CPH = detail::CountProducts<LocalOpT>(PH);
+    Real energy = NAN;
+    if(args.getInt("MaxSubspace",0) <= 0)
+        {
+        energy = davidson(CPH,phi,args);
+        }
+    else
+        {
+        auto v = std::vector<ITensor>{phi};
+        energy = blockDavidson(CPH,v,args).front();
+        phi = v.front();
+        }
+    nproduct = CPH.count;
+    return energy;
+    }
+
 //
 // DMRGWorker
 //
@@ -327,6 +473,7 @@ DMRGWorker(MPS & psi,
            DMRGObserver & obs,
            Args args)
     {
+    PROFILE_SCOPE("dmrg")
     if( args.defined("WriteM") )
       {
       if( args.defined("WriteDim") )
@@ -357,6 +504,14 @@ DMRGWorker(MPS & psi,
     const int N = length(psi);
     Real energy = NAN;
 
+    //Number of sites optimized at each step (1 or 2);
+    //PH must have been made with the same "NumCenter"
+    const int numCenter = args.getInt("NumCenter",2);
+    if(numCenter != 1 && numCenter != 2)
+        {
+        Error("DMRG: NumCenter must be 1 or 2");
+        }
+
     psi.position(1);
 
     args.add("DebugLevel",debug_level);
@@ -364,6 +519,7 @@ DMRGWorker(MPS & psi,
     
     for(int sw = 1; sw <= sweeps.nsweep(); ++sw)
         {
+        PROFILE_SCOPE("sweep")
         cpu_time sw_time;
         args.add("Sweep",sw);
         args.add("NSweep",sweeps.nsweep());
@@ -394,13 +550,33 @@ DMRGWorker(MPS & psi,
                 printfln("Sweep=%d, HS=%d, Bond=%d/%d",sw,ha,b,(N-1));
                 }
 
-            PH.position(b,psi);
+            PROFILE_SCOPE("bond")
+            Spectrum spec;
+            long nproduct = 0;
+            if(numCenter == 1)
+                {
+                //Optimize site b going right, site b+1 going left,
+                //then move the orthogonality center across bond b
+                auto j = (ha==1 ? b : b+1);
 
-            auto phi = psi(b)*psi(b+1);
+                PH.position(j,psi);
 
-            energy = davidson(PH,phi,args);
-            
-            auto spec = psi.svdBond(b,phi,(ha==1?Fromleft:Fromright),PH,args);
+                auto phi = psi(j);
+
+                energy = DMRGEigensolve(PH,phi,nproduct,args);
+
+                spec = splitSiteBond(psi,b,phi,(ha==1?Fromleft:Fromright),PH,args);
+                }
+            else
+                {
+                PH.position(b,psi);
+
+                auto phi = psi(b)*psi(b+1);
+
+                energy = DMRGEigensolve(PH,phi,nproduct,args);
+                
+                spec = psi.svdBond(b,phi,(ha==1?Fromleft:Fromright),PH,args);
+                }
 
             if(!quiet)
                 { 
@@ -419,6 +595,7 @@ DMRGWorker(MPS & psi,
             args.add("HalfSweep",ha);
             args.add("Energy",energy); 
             args.add("Truncerr",spec.truncerr()); 
+            args.add("DavidsonProducts",nproduct);
 
             obs.measure(args);
 
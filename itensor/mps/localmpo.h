@@ -17,6 +17,7 @@
 #define __ITENSOR_LOCALMPO
 #include "itensor/mps/mpo.h"
 #include "itensor/mps/localop.h"
+#include "itensor/mps/diskcache.h"
 #include "itensor/util/print_macro.h"
 
 namespace itensor {
@@ -106,6 +107,12 @@ class LocalMPO
     void
     product(const ITensor& phi, ITensor& phip) const;
 
+    //Block product phip[n] = H*phi[n], done in one
+    //contraction by LocalOp::product if possible
+    void
+    product(std::vector<ITensor> const& phi,
+            std::vector<ITensor> & phip) const;
+
     Real
     expect(const ITensor& phi) const { return lop_.expect(phi); }
 
@@ -188,6 +195,16 @@ class LocalMPO
 
     bool
     doWrite() const { return do_write_; }
+
+    //
+    //Store environment tensors not in use on disk
+    //(in a temporary directory inside "WriteDir").
+    //Files are written and read on a background
+    //thread: the next environment in the direction
+    //of a sweep is read ahead of time, and up to
+    //"WriteCacheMB" megabytes of environments
+    //already on disk are also kept in memory.
+    //
     void
     doWrite(bool val,
             Args const& args = Args::global()) 
@@ -225,6 +242,7 @@ class LocalMPO
 
     bool do_write_ = false;
     std::string writedir_ = "./";
+    std::shared_ptr<DiskCache> disk_;
 
     const MPS* Psi_;
 
@@ -361,8 +379,15 @@ product(ITensor const& phi,
         {
         int b = position();
         auto othr = (!L() ? dag(prime(Psi_->A(b),"Link")) : L()*dag(prime(Psi_->A(b),"Link")));
-        auto othrR = (!R() ? dag(prime(Psi_->A(b+1),"Link")) : R()*dag(prime(Psi_->A(b+1),"Link")));
-        othr *= othrR;
+        if(nc_ == 2)
+            {
+            auto othrR = (!R() ? dag(prime(Psi_->A(b+1),"Link")) : R()*dag(prime(Psi_->A(b+1),"Link")));
+            othr *= othrR;
+            }
+        else if(R())
+            {
+            othr *= R();
+            }
         auto z = (othr*phi).eltC();
 
         phip = dag(othr);
@@ -374,6 +399,19 @@ product(ITensor const& phi,
         }
     }
 
+void inline LocalMPO::
+product(std::vector<ITensor> const& phi,
+        std::vector<ITensor>      & phip) const
+    {
+    if(Op_ != 0)
+        {
+        lop_.product(phi,phip);
+        return;
+        }
+    phip.resize(phi.size());
+    for(auto n : range(phi)) product(phi[n],phip[n]);
+    }
+
 void inline LocalMPO::
 L(int j, ITensor const& nL)
     {
@@ -391,6 +429,7 @@ R(int j, ITensor const& nR)
 inline void LocalMPO::
 position(int b, MPS const& psi)
     {
+    PROFILE_SCOPE("position")
     if(!(*this)) Error("LocalMPO is null");
 
     makeL(psi,b-1);
@@ -399,16 +438,15 @@ position(int b, MPS const& psi)
     setLHlim(b-1); //not redundant since LHlim_ could be > b-1
     setRHlim(b+nc_); //not redundant since RHlim_ could be < b+nc_
 
-#ifdef DEBUG
-    if(nc_ != 2)
+    if(nc_ > 2)
         {
-        Error("LocalOp only supports 2 center sites currently");
+        Error("LocalOp only supports 1 or 2 center sites currently");
         }
-#endif
 
     if(Op_ != 0) //normal MPO case
         {
-        lop_.update(Op_->A(b),Op_->A(b+1),L(),R());
+        if(nc_ == 2) lop_.update(Op_->A(b),Op_->A(b+1),L(),R());
+        else         lop_.update(Op_->A(b),L(),R());
         }
     }
 
@@ -429,12 +467,10 @@ shift(int j,
     {
     if(!(*this)) Error("LocalMPO is null");
 
-#ifdef DEBUG
-    if(nc_ != 2)
+    if(nc_ > 2)
         {
-        Error("LocalOp only supports 2 center sites currently");
+        Error("LocalOp only supports 1 or 2 center sites currently");
         }
-#endif
 
     if(dir == Fromleft)
         {
@@ -451,7 +487,8 @@ shift(int j,
         setLHlim(j);
         setRHlim(j+nc_+1);
 
-        lop_.update(Op_->A(j+1),Op_->A(j+2),L(),R());
+        if(nc_ == 2) lop_.update(Op_->A(j+1),Op_->A(j+2),L(),R());
+        else         lop_.update(Op_->A(j+1),L(),R());
         }
     else //dir == Fromright
         {
@@ -468,7 +505,8 @@ shift(int j,
         setLHlim(j-nc_-1);
         setRHlim(j);
 
-        lop_.update(Op_->A(j-1),Op_->A(j),L(),R());
+        if(nc_ == 2) lop_.update(Op_->A(j-1),Op_->A(j),L(),R());
+        else         lop_.update(Op_->A(j-1),L(),R());
         }
     }
 
@@ -561,9 +599,10 @@ setLHlim(int val)
 
     if(LHlim_ != val && PH_.at(LHlim_))
         {
-        writeToFile(PHFName(LHlim_),PH_.at(LHlim_));
+        disk_->write(PHFName(LHlim_),std::move(PH_.at(LHlim_)));
         PH_.at(LHlim_) = ITensor();
         }
+    auto prev = LHlim_;
     LHlim_ = val;
     if(LHlim_ < 1) 
         {
@@ -573,9 +612,10 @@ setLHlim(int val)
         }
     if(!PH_.at(LHlim_))
         {
-        std::string fname = PHFName(LHlim_);
-        readFromFile(fname,PH_.at(LHlim_));
+        PH_.at(LHlim_) = disk_->read(PHFName(LHlim_));
         }
+    //Read ahead the environment needed after this one
+    if(LHlim_ < prev && LHlim_ > 1) disk_->prefetch(PHFName(LHlim_-1));
     }
 
 void inline LocalMPO::
@@ -589,9 +629,10 @@ setRHlim(int val)
 
     if(RHlim_ != val && PH_.at(RHlim_))
         {
-        writeToFile(PHFName(RHlim_),PH_.at(RHlim_));
+        disk_->write(PHFName(RHlim_),std::move(PH_.at(RHlim_)));
         PH_.at(RHlim_) = ITensor();
         }
+    auto prev = RHlim_;
     RHlim_ = val;
     if(RHlim_ > Op_->length()) 
         {
@@ -601,9 +642,10 @@ setRHlim(int val)
         }
     if(!PH_.at(RHlim_))
         {
-        std::string fname = PHFName(RHlim_);
-        readFromFile(fname,PH_.at(RHlim_));
+        PH_.at(RHlim_) = disk_->read(PHFName(RHlim_));
         }
+    //Read ahead the environment needed after this one
+    if(RHlim_ > prev && RHlim_ < Op_->length()) disk_->prefetch(PHFName(RHlim_+1));
     }
 
 void inline LocalMPO::
@@ -611,6 +653,8 @@ initWrite(Args const& args)
     {
     auto basedir = args.getString("WriteDir","./");
     writedir_ = mkTempDir("PH",basedir);
+    auto cache_mb = args.getReal("WriteCacheMB",0.);
+    disk_ = std::make_shared<DiskCache>(size_t(cache_mb*1024*1024));
     }
 
 } //namespace itensor
@@ -74,6 +74,11 @@ class LocalMPO_MPS
     size_t
     size() const { return lmpo_.size(); }
 
+    int
+    numCenter() const { return lmpo_.numCenter(); }
+    void
+    numCenter(int val);
+
     explicit
     operator bool() const { return bool(Op_); }
 
@@ -97,11 +102,11 @@ LocalMPO_MPS(MPO const& Op,
     lmps_(psis.size()),
     weight_(args.getReal("Weight",1))
     { 
-    lmpo_ = LocalMPO(Op);
+    lmpo_ = LocalMPO(Op,args);
 
     for(auto j : range(lmps_.size()))
         {
-        lmps_[j] = LocalMPO(psis[j]);
+        lmps_[j] = LocalMPO(psis[j],args);
         }
     }
 
@@ -117,7 +122,7 @@ LocalMPO_MPS(MPO const& Op,
     lmps_(psis.size()),
     weight_(args.getReal("Weight",1))
     { 
-    lmpo_ = LocalMPO(Op,LOp,ROp);
+    lmpo_ = LocalMPO(Op,LOp,ROp,args);
 #ifdef DEBUG
     if(Lpsi.size() != psis.size()) Error("Lpsi must have same number of elements as psis");
     if(Rpsi.size() != psis.size()) Error("Rpsi must have same number of elements as psis");
@@ -125,7 +130,7 @@ LocalMPO_MPS(MPO const& Op,
 
     for(auto j : range(lmps_.size()))
         {
-        lmps_[j] = LocalMPO(psis[j],Lpsi[j],Rpsi[j]);
+        lmps_[j] = LocalMPO(psis[j],Lpsi[j],Rpsi[j],args);
         }
     }
 
@@ -154,6 +159,16 @@ position(int b, const MPS& psi)
         }
     }
 
+void inline LocalMPO_MPS::
+numCenter(int val)
+    {
+    lmpo_.numCenter(val);
+    for(auto& M : lmps_)
+        {
+        M.numCenter(val);
+        }
+    }
+
 } //namespace itensor
 
 #endif
@@ -117,7 +117,7 @@ LocalMPOSet(std::vector<MPO> const& Op,
     { 
     for(auto n : range(lmpo_.size()))
         {
-        lmpo_[n] = LocalMPO(Op.at(n));
+        lmpo_[n] = LocalMPO(Op.at(n),args);
         }
     }
 
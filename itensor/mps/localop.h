@@ -33,6 +33,11 @@ namespace itensor {
 //   |    |      |    |
 //   '-              -'
 //
+// If updated with only one operator
+// tensor (Op2 null), it represents the
+// operator projected into the space of
+// one site, as used for single-site DMRG.
+//
 // (Note that L, Op1, Op2 and R
 //  are not required to have this
 //  precise structure. L and R
@@ -48,6 +53,31 @@ class LocalOp
     ITensor const* L_;
     ITensor const* R_;
     mutable size_t size_;
+
+    //Contraction plan for product, made on the first
+    //call to product with phi having indices is:
+    // o chain lists the tensors in the order they
+    //   are multiplied onto phi
+    // o If store[n] is not null, it is used in place
+    //   of *chain[n] - a copy of Op1 or Op2 with indices
+    //   reordered to avoid a permutation per call
+    // o If pre[n] is not empty, the intermediate tensor
+    //   is permuted to it before multiplying by *chain[n],
+    //   so that L and R (which can be large) are never
+    //   copied or permuted when avoidable
+    struct ProductPlan
+        {
+        IndexSet is;
+        std::vector<ITensor const*> chain;
+        std::vector<ITensor> store;
+        std::vector<IndexSet> pre;
+        };
+    //Plans made since the last call to update, one per
+    //set of indices product was called with
+    mutable std::vector<ProductPlan> plans_;
+    //batch_[nb] is the Index labeling the nb vectors stacked
+    //by the block product, kept so its plan can be reused
+    mutable std::vector<Index> batch_;
     public:
 
 
@@ -74,6 +104,17 @@ class LocalOp
     void
     product(ITensor const& phi, ITensor & phip) const;
 
+    //Block product phip[n] = H*phi[n]: for QN
+    //tensors the phi[n] (which must all have the
+    //same indices) are stacked along an extra index
+    //and multiplied by L, Op1, Op2 and R together,
+    //turning many small block products into fewer
+    //larger ones (dense tensors gain nothing from
+    //this, so they are multiplied one at a time)
+    void
+    product(std::vector<ITensor> const& phi,
+            std::vector<ITensor> & phip) const;
+
     Real
     expect(ITensor const& phi) const;
 
@@ -82,6 +123,10 @@ class LocalOp
              ITensor const& combine, 
              Direction dir) const;
 
+    //Diagonal elements of the operator, as a tensor
+    //with the indices of phi; for QN operators it
+    //has no QNs, and multiplies QN tensors with
+    //the non-contracting product (q /= diag())
     ITensor
     diag() const;
 
@@ -101,6 +146,16 @@ class LocalOp
            ITensor const& L, 
            ITensor const& R);
 
+    //Single site version
+    void
+    update(ITensor const& Op1, 
+           ITensor const& L, 
+           ITensor const& R);
+
+    //Number of sites (1 or 2)
+    int
+    numCenter() const { return Op2_ ? 2 : 1; }
+
     ITensor const&
     Op1() const 
         { 
@@ -112,6 +167,7 @@ class LocalOp
     Op2() const 
         { 
         if(!(*this)) Error("LocalOp is default constructed");
+        if(!Op2_) Error("LocalOp has only one site");
         return *Op2_;
         }
 
@@ -137,6 +193,14 @@ class LocalOp
     bool
     RIsNull() const;
 
+    private:
+
+    ProductPlan
+    makeProductPlan(ITensor const& phi) const;
+
+    ProductPlan const&
+    productPlan(ITensor const& phi) const;
+
     };
 
 inline LocalOp::
@@ -185,6 +249,7 @@ update(const ITensor& Op1, const ITensor& Op2)
     L_ = nullptr;
     R_ = nullptr;
     size_ = -1;
+    plans_.clear();
     }
 
 void inline LocalOp::
@@ -196,6 +261,19 @@ update(const ITensor& Op1, const ITensor& Op2,
     R_ = &R;
     }
 
+void inline LocalOp::
+update(ITensor const& Op1, 
+       ITensor const& L, 
+       ITensor const& R)
+    {
+    Op1_ = &Op1;
+    Op2_ = nullptr;
+    L_ = &L;
+    R_ = &R;
+    size_ = -1;
+    plans_.clear();
+    }
+
 bool inline LocalOp::
 LIsNull() const
     {
@@ -210,37 +288,198 @@ RIsNull() const
     return !bool(*R_);
     }
 
+//
+// Decide in which order to multiply L, Op1, Op2 and R
+// onto phi (starting from the L or from the R end, 
+// whichever is estimated to take fewer operations) and
+// arrange indices so that:
+//
+// o Contracted indices of Op1 and Op2 come first, in
+//   the order they have on the intermediate tensor,
+//   using reordered copies of these small tensors
+// o L and R are used as they are: if their contracted
+//   indices are grouped at the front or back, the
+//   intermediate tensor is permuted to match them instead
+// o Indices left for later operators come last, so 
+//   each intermediate only gets permuted when its
+//   contracted indices cannot be grouped
+//
+LocalOp::ProductPlan inline LocalOp::
+makeProductPlan(ITensor const& phi) const
+    {
+    auto fromL = std::vector<ITensor const*>{};
+    if(!LIsNull()) fromL.push_back(L_);
+    fromL.push_back(Op1_);
+    if(Op2_) fromL.push_back(Op2_);
+    if(!RIsNull()) fromL.push_back(R_);
+    auto fromR = std::vector<ITensor const*>(fromL.rbegin(),fromL.rend());
+
+    //Estimate of the number of operations
+    //for multiplying phi by each tensor of chain 
+    auto chainCost = [&phi](std::vector<ITensor const*> const& chain)
+        {
+        Real cost = 0.;
+        auto cur = phi.inds();
+        for(auto* T : chain)
+            {
+            auto& Tis = T->inds();
+            Real c = 1.;
+            for(auto& i : cur) c *= dim(i);
+            for(auto& i : Tis) if(!hasIndex(cur,i)) c *= dim(i);
+            cost += c;
+            cur = unionInds(uniqueInds(cur,Tis),uniqueInds(Tis,cur));
+            }
+        return cost;
+        };
+
+    auto P = ProductPlan{};
+    P.is = phi.inds();
+    P.chain = (chainCost(fromR) < chainCost(fromL)) ? fromR : fromL;
+    auto& chain = P.chain;
+    P.store.assign(chain.size(),ITensor{});
+    P.pre.assign(chain.size(),IndexSet{});
+    auto cur = phi.inds();
+    for(auto n : range(chain))
+        {
+        auto& T = *chain[n];
+        auto& Tis = T.inds();
+
+        if(chain[n] == Op1_ || chain[n] == Op2_)
+            {
+            auto TisB = IndexSetBuilder(order(Tis));
+            //Contracted indices first, in the
+            //same order they have on cur
+            for(auto& i : cur) if(hasIndex(Tis,i)) TisB.nextIndex(i);
+            //Then indices only on T, with those
+            //shared with a later tensor of the chain last
+            auto isLater = [&chain,n](Index const& i)
+                {
+                for(auto m = n+1; m < chain.size(); ++m)
+                    if(hasIndex(*chain[m],i)) return true;
+                return false;
+                };
+            for(auto& i : Tis) if(!hasIndex(cur,i) && !isLater(i)) TisB.nextIndex(i);
+            for(auto& i : Tis) if(!hasIndex(cur,i) && isLater(i)) TisB.nextIndex(i);
+            auto newis = TisB.build();
+
+            auto same_order = true;
+            for(auto j : range(order(Tis))) if(Tis[j] != newis[j]) same_order = false;
+            if(!same_order) P.store[n] = permute(T,newis);
+            cur = unionInds(uniqueInds(cur,newis),uniqueInds(newis,cur));
+            continue;
+            }
+
+        //L or R: if its contracted indices are grouped, put
+        //the uncontracted indices of cur first, followed by
+        //the contracted ones in the order they have on T
+        auto cpos = std::vector<long>{};
+        for(auto j : range(order(Tis))) if(hasIndex(cur,Tis[j])) cpos.push_back(j);
+        auto nc = long(cpos.size());
+        auto grouped = nc > 0
+                    && (cpos.back()-cpos.front()+1 == nc)
+                    && (cpos.front() == 0 || cpos.back() == order(Tis)-1);
+        if(grouped)
+            {
+            auto curB = IndexSetBuilder(order(cur));
+            for(auto& i : cur) if(!hasIndex(Tis,i)) curB.nextIndex(i);
+            for(auto j : cpos) curB.nextIndex(Tis[j]);
+            auto newcur = curB.build();
+            auto same_order = true;
+            for(auto j : range(order(cur))) if(cur[j] != newcur[j]) same_order = false;
+            if(!same_order)
+                {
+                P.pre[n] = newcur;
+                cur = newcur;
+                }
+            }
+        cur = unionInds(uniqueInds(cur,Tis),uniqueInds(Tis,cur));
+        }
+    return P;
+    }
+
+inline LocalOp::ProductPlan const& LocalOp::
+productPlan(ITensor const& phi) const
+    {
+    for(auto& P : plans_)
+        {
+        if(hasSameInds(P.is,phi.inds())) return P;
+        }
+    plans_.push_back(makeProductPlan(phi));
+    return plans_.back();
+    }
+
 void inline LocalOp::
 product(ITensor const& phi, 
         ITensor      & phip) const
     {
+    PROFILE_SCOPE("product")
     if(!(*this)) Error("LocalOp is null");
 
-    auto& Op1 = *Op1_;
-    auto& Op2 = *Op2_;
+    auto& P = productPlan(phi);
 
-    if(LIsNull())
+    phip = phi;
+    for(auto n : range(P.chain))
         {
-        phip = phi;
+        if(order(P.pre[n]) > 0) phip.permute(P.pre[n]);
+        if(P.store[n]) phip *= P.store[n];
+        else           phip *= *P.chain[n];
+        }
 
-        if(!RIsNull()) 
-            phip *= R(); //m^3 k d
+    phip.replaceTags("1","0");
 
-        phip *= Op2; //m^2 k^2
-        phip *= Op1; //m^2 k^2
+    //Return phip with the index order of phi, so that
+    //linear combinations and inner products of phi and
+    //phip (as in davidson) do not need to permute
+    auto& is = phi.inds();
+    auto& pis = phip.inds();
+    if(order(pis) != order(is) || !hasSameInds(pis,is)) return;
+    for(auto j : range(order(is))) 
+        {
+        if(pis[j] != is[j])
+            {
+            phip.permute(is);
+            break;
+            }
         }
-    else
+    }
+
+void inline LocalOp::
+product(std::vector<ITensor> const& phi,
+        std::vector<ITensor>      & phip) const
+    {
+    auto nb = phi.size();
+    phip.resize(nb);
+    if(nb == 0) return;
+    if(nb == 1 || !hasQNs(phi.front()))
         {
-        phip = phi * L(); //m^3 k d
+        for(auto n : range(nb)) product(phi[n],phip[n]);
+        return;
+        }
 
-        phip *= Op1; //m^2 k^2
-        phip *= Op2; //m^2 k^2
+    if(batch_.size() <= nb) batch_.resize(nb+1);
+    if(!batch_[nb]) batch_[nb] = Index(QN(),nb,"Batch");
+    auto& b = batch_[nb];
 
-        if(!RIsNull()) 
-            phip *= R();
+    ITensor X;
+    for(auto n : range(nb))
+        {
+        if(!hasSameInds(phi[n].inds(),phi.front().inds()))
+            {
+            Error("LocalOp::product: all vectors of a block must have the same indices");
+            }
+        auto Xn = phi[n]*setElt(b=1+n);
+        if(n == 0) X = Xn;
+        else       X += Xn;
         }
 
-    phip.replaceTags("1","0");
+    ITensor Y;
+    product(X,Y);
+
+    for(auto n : range(nb))
+        {
+        phip[n] = Y*setElt(dag(b)=1+n);
+        phip[n].permute(phi[n].inds());
+        }
     }
 
 Real inline LocalOp::
@@ -265,7 +504,7 @@ deltaRho(ITensor const& AA,
     else //dir == Fromright
         {
         if(!RIsNull()) drho *= R();
-        drho *= (*Op2_);
+        drho *= (Op2_ ? *Op2_ : *Op1_);
         }
     drho.noPrime();
     drho = combine * drho;
@@ -285,9 +524,6 @@ diag() const
     {
     if(!(*this)) Error("LocalOp is null");
 
-    auto& Op1 = *Op1_;
-    auto& Op2 = *Op2_;
-
     //lambda helper function:
     auto findIndPair = [](ITensor const& T) {
         for(auto& s : T.inds())
@@ -300,40 +536,47 @@ diag() const
         return Index();
         };
 
-    auto toTie = findIndex(Op1,"Site,0");
-    auto Diag = Op1 * delta(toTie,prime(toTie),prime(toTie,2));
-    Diag.noPrime();
-
-    toTie = findIndex(Op2,"Site,0");
-    auto Diag2 = Op2 * delta(toTie,prime(toTie),prime(toTie,2));
-    Diag *= noPrime(Diag2);
-
-    if(!LIsNull())
-        {
-        toTie = findIndPair(L());
-        if(toTie)
+    //Diagonal of T over the index pair (i,prime(i)).
+    //It has no definite QN flux (every block of T
+    //contributes to it), so for QN tensors it is read
+    //off block by block into dense storage, which is
+    //much smaller than a dense copy of T
+    auto tieDiag = [](ITensor T, Index const& i) -> ITensor {
+        if(!hasQNs(T))
             {
-            auto DiagL = L() * delta(toTie,prime(toTie),prime(toTie,2));
-            Diag *= noPrime(DiagL);
+            T *= delta(i,prime(i),prime(i,2));
+            return T.noPrime();
             }
-        else
+        auto i1 = indexPosition(inds(T),i),
+             i2 = indexPosition(inds(T),prime(i));
+        if(T.store()) doTask(TieDiag{inds(T),i1,i2},T.store());
+        auto nis = std::vector<Index>();
+        for(auto j : range(order(T)))
             {
-            Diag *= L();
+            if(j != i2) nis.push_back(removeQNs(inds(T)[j]));
             }
+        return ITensor{IndexSet(nis),std::move(T.store()),T.scale()};
+        };
+
+    auto Diag = tieDiag(*Op1_,findIndex(*Op1_,"Site,0"));
+
+    if(Op2_)
+        {
+        Diag *= tieDiag(*Op2_,findIndex(*Op2_,"Site,0"));
+        }
+
+    if(!LIsNull())
+        {
+        auto toTie = findIndPair(L());
+        if(toTie) Diag *= tieDiag(L(),toTie);
+        else      Diag *= removeQNs(L());
         }
 
     if(!RIsNull())
         {
-        toTie = findIndPair(R());
-        if(toTie)
-            {
-            auto DiagR = R() * delta(toTie,prime(toTie),prime(toTie,2));
-            Diag *= noPrime(DiagR);
-            }
-        else
-            {
-            Diag *= R();
-            }
+        auto toTie = findIndPair(R());
+        if(toTie) Diag *= tieDiag(R(),toTie);
+        else      Diag *= removeQNs(R());
         }
 
     Diag.dag();
@@ -376,7 +619,7 @@ size() const
             }
 
         size_ *= dim(findIndex(*Op1_,"Site,0"));
-        size_ *= dim(findIndex(*Op2_,"Site,0"));
+        if(Op2_) size_ *= dim(findIndex(*Op2_,"Site,0"));
         }
     return size_;
     }
@@ -86,13 +86,13 @@ class MPO : private MPS
     MPO&
     swapSiteInds();
 
-    void 
+    Spectrum
     svdBond(int b, 
             ITensor const& AA, 
             Direction dir, 
             Args const& args = Args::global())
         { 
-        Parent::svdBond(b,AA,dir,args + Args("UseSVD",true,"LogRefNorm",logrefNorm_)); 
+        return Parent::svdBond(b,AA,dir,args + Args("UseSVD",true,"LogRefNorm",logrefNorm_));
         }
 
     //Move the orthogonality center to site i 
@@ -447,7 +447,33 @@ innerC(MPS const& x,
        MPS const& y);
 
 // Calculate AB
-void 
+//
+//{"Method=","DensityMatrix"} (default):
+//Sweeps once from the left, truncating each bond
+//as it is formed with "Cutoff" (default: 1E-14)
+//and "MaxDim". Without "MaxDim" the bonds can grow to
+//the product of those of A and B, and the density
+//matrices formed to the square of that.
+//
+//{"Method=","Fit"}:
+//Fits res to AB by two-site sweeps maximizing <res|AB>,
+//starting from a "DensityMatrix" product truncated to
+//"MaxDim" (required) with cutoff "ZipUpCutoff" (default:
+//the smaller of 1E-8 and "Cutoff"). Nothing larger than
+//the bond dimension of res times those of A and B
+//is formed, so memory grows with the output bond
+//dimension only.
+//List of options recognized:
+//   Nsweep (default: 2) - number of sweeps
+//   MaxDim - maximum bond dimension of res
+//   Cutoff (default: 1E-14) - truncation error goal
+//   Verbose (default: false) - print each bond
+//
+//If "Fidelity" is true (default: false) returns the
+//fidelity |<res|AB>|^2/(<res|res><AB|AB>), otherwise -1.
+//Computing <AB|AB> needs tensors as large as the square
+//of the bond dimension of A times that of B.
+Real
 nmultMPO(MPO const& Aorig, 
          MPO const& Borig, 
          MPO & res,
@@ -469,10 +495,20 @@ nmultMPO(MPO const& A,
 //be controllably truncated further by providing
 //optional truncation args "Cutoff" and "MaxDim"
 //
+//{"Method=","ZipUp"}
+//Applies an MPO K to an MPS x in a single sweep from
+//the left, truncating each bond as soon as it is formed
+//with "Cutoff" (default: 1E-8) and "MaxDim". Faster than
+//"DensityMatrix" and needs far less memory, but the
+//truncations are only approximately optimal.
+//
 //{"Method=","Fit"}
 //Applies an MPO K to an MPS psi (|res>=K|psi>) using a sweeping/DMRG-like
 //fitting approach. Warning: this method can get stuck i.e. fail to converge
 //if the initial value of res is too different from the product K|psi>.
+//By default the starting state is a "ZipUp" of K|psi> with cutoff
+//"ZipUpCutoff" (default: the smaller of 1E-8 and "Cutoff") and
+//"MaxDim"; set "ZipUpGuess" to false to start from psi instead.
 //List of options recognized:
 //   Normalize (default: true) - normalize state to 1 after applying MPO
 //   Nsweep (default: 1) - number of sweeps to use
@@ -13,7 +13,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
+#include <algorithm>
+#include <numeric>
 #include "itensor/util/print_macro.h"
+#include "itensor/util/threadpool.h"
 #include "itensor/mps/mpo.h"
 #include "itensor/mps/localop.h"
 
@@ -30,7 +33,61 @@ using std::pair;
 using std::make_pair;
 using std::string;
 
-void
+Real
+fitMultMPOImpl(MPO const& A,
+               MPO const& B,
+               MPO& res,
+               Args args);
+
+//|<C|AB>|^2/(<C|C><AB|AB>)
+Real
+multMPOFidelity(MPO const& A,
+                MPO const& B,
+                MPO const& C)
+    {
+    auto N = length(A);
+    //Copy of M(n) with its link indices replaced
+    //by the similar indices l, for the conjugates
+    auto relink = [N](MPO const& M, IndexSet const& l, int n)
+        {
+        auto T = M(n);
+        if(n > 1) T.replaceInds(IndexSet(leftLinkIndex(M,n)),IndexSet(l(n-1)));
+        if(n < N) T.replaceInds(IndexSet(rightLinkIndex(M,n)),IndexSet(l(n)));
+        return T;
+        };
+    auto lA = sim(linkInds(A)),
+         lB = sim(linkInds(B)),
+         lC = sim(linkInds(C));
+
+    //<AB|AB> is the only part with tensors as
+    //large as the square of the bond dimension
+    //of A times that of B
+    ITensor CAB,CC,ABAB;
+    for(auto n : range1(N))
+        {
+        auto s = IndexSet(commonIndex(A(n),B(n)));
+        auto sn = sim(s);
+        auto Ad = relink(A,lA,n);
+        Ad.replaceInds(s,sn);
+        auto Bd = relink(B,lB,n);
+        Bd.replaceInds(s,sn);
+
+        CAB = (CAB ? CAB*A(n) : A(n));
+        CAB *= B(n);
+        CAB *= dag(C(n));
+
+        CC = (CC ? CC*C(n) : C(n));
+        CC *= dag(relink(C,lC,n));
+
+        ABAB = (ABAB ? ABAB*A(n) : A(n));
+        ABAB *= B(n);
+        ABAB *= dag(Ad);
+        ABAB *= dag(Bd);
+        }
+    return std::norm(eltC(CAB))/(std::abs(eltC(CC))*std::abs(eltC(ABAB)));
+    }
+
+Real
 nmultMPO(MPO const& Aorig,
          MPO const& Borig,
          MPO& res,
@@ -40,6 +97,17 @@ nmultMPO(MPO const& Aorig,
     if(!args.defined("RespectDegenerate")) args.add("RespectDegenerate",true);
 
     if(length(Aorig) != length(Borig)) Error("nmultMPO(MPO): Mismatched MPO length");
+
+    auto method = args.getString("Method","DensityMatrix");
+    if(method == "Fit")
+        {
+        return fitMultMPOImpl(Aorig,Borig,res,args);
+        }
+    else if(method != "DensityMatrix")
+        {
+        Error("nmultMPO currently supports the following methods: 'DensityMatrix', 'Fit'");
+        }
+
     const int N = length(Borig);
 
     auto A = Aorig;
@@ -91,6 +159,9 @@ nmultMPO(MPO const& Aorig,
 
     res.svdBond(N-1,nfork,Fromright, args);
     res.orthogonalize();
+
+    if(!args.getBool("Fidelity",false)) return -1;
+    return multMPOFidelity(Aorig,Borig,res);
     }
 
 MPO
@@ -112,6 +183,11 @@ densityMatrixApplyMPOImpl(MPO const& K,
                           MPS const& x,
                           Args args = Args::global());
 
+MPS
+zipUpApplyMPOImpl(MPO const& K,
+                  MPS const& x,
+                  Args const& args = Args::global());
+
 void
 fitApplyMPOImpl(MPS const& psi,
                 MPO const& K,
@@ -134,20 +210,34 @@ applyMPO(MPO const& K,
         {
         res = densityMatrixApplyMPOImpl(K,x,args);
         }
+    else if(method == "ZipUp")
+        {
+        res = zipUpApplyMPOImpl(K,x,args);
+        }
     else if(method == "Fit")
         {
-        // Use the input MPS x to be applied as the
-        // default starting state
-        // TODO: consider using zipUpApplyMPOImpl as 
-        // a way to get a better starting state
-        auto sites = uniqueSiteInds(K,x);
-        res = replaceSiteInds(x,sites);
-        //res = x;
+        if(args.getBool("ZipUpGuess",true))
+            {
+            // Start from a loosely truncated zip-up
+            // of K|x>, which is usually much closer
+            // to the result than x itself
+            auto zcutoff = std::max(0.,std::min(1E-8,args.getReal("Cutoff",1E-8)));
+            auto zargs = Args{"Cutoff",args.getReal("ZipUpCutoff",zcutoff)};
+            if(args.defined("MaxDim")) zargs.add("MaxDim",args.getInt("MaxDim"));
+            res = zipUpApplyMPOImpl(K,x,zargs);
+            }
+        else
+            {
+            // Use the input MPS x to be applied as the
+            // starting state
+            auto sites = uniqueSiteInds(K,x);
+            res = replaceSiteInds(x,sites);
+            }
         fitApplyMPOImpl(x,K,res,args);
         }
     else
         {
-        Error("applyMPO currently supports the following methods: 'DensityMatrix', 'Fit'");
+        Error("applyMPO currently supports the following methods: 'DensityMatrix', 'ZipUp', 'Fit'");
         }
 
     return res;
@@ -168,12 +258,12 @@ applyMPO(MPO const& K,
     if(!args.defined("RespectDegenerate")) args.add("RespectDegenerate",true);
 
     MPS res = x0;
-    if(method == "DensityMatrix")
-        Error("applyMPO method 'DensityMatrix' does not accept an input MPS");
+    if(method == "DensityMatrix" || method == "ZipUp")
+        Error(format("applyMPO method '%s' does not accept an input MPS",method));
     else if(method == "Fit")
         fitApplyMPOImpl(x,K,res,args);
     else
-        Error("applyMPO currently supports the following methods: 'DensityMatrix', 'Fit'");
+        Error("applyMPO currently supports the following methods: 'DensityMatrix', 'ZipUp', 'Fit'");
 
     return res;
     }
@@ -182,6 +272,61 @@ applyMPO(MPO const& K,
 // Implement specific applyMPO methods
 //
 
+//Computes E*T[0]*T[1]*... (or T[0]*T[1]*... if E
+//is empty), where i is an index of T[0] left
+//uncontracted. If i has QNs, its blocks are split
+//into chunks which are contracted concurrently
+//on "NThread" threads (read from Args::global())
+//and the results summed.
+ITensor static
+envProduct(ITensor const& E,
+           std::vector<ITensor> const& T,
+           Index const& i)
+    {
+    auto contractAll = [&E,&T](ITensor A)
+        {
+        if(E) A = E*A;
+        for(auto n : range(1,T.size())) A *= T[n];
+        return A;
+        };
+
+    auto nthread = Args::global().getInt("NThread",1);
+    auto nchunk = hasQNs(i) ? std::min<long>(nthread,nblock(i)) : 1l;
+    if(nchunk <= 1) return contractAll(T[0]);
+
+    auto offset = std::vector<long>(nblock(i)+1,0);
+    for(auto b : range1(nblock(i))) offset[b] = offset[b-1]+blocksize(i,b);
+
+    //Put the largest blocks first,
+    //each onto the least loaded chunk
+    auto order = std::vector<long>(nblock(i));
+    std::iota(order.begin(),order.end(),1l);
+    std::stable_sort(order.begin(),order.end(),[&i](long a, long b)
+        { return blocksize(i,a) > blocksize(i,b); });
+    auto load = std::vector<long>(nchunk,0);
+    auto P = std::vector<ITensor>(nchunk);
+    for(auto& p : P) p = ITensor(dag(i),prime(i));
+    for(auto b : order)
+        {
+        auto c = std::min_element(load.begin(),load.end())-load.begin();
+        load[c] += blocksize(i,b);
+        for(auto n : range1(offset[b-1]+1,offset[b]))
+            {
+            P[c].set(dag(i)=n,prime(i)=n,1.);
+            }
+        }
+
+    auto R = std::vector<ITensor>(nchunk);
+    threadPool(nthread).run(nchunk,[&](long c)
+        {
+        auto A = T[0]*P[c];
+        A.replaceInds(IndexSet(prime(i)),IndexSet(i));
+        R[c] = contractAll(A);
+        },nthread);
+    auto res = R[0];
+    for(auto c : range(1,nchunk)) res += R[c];
+    return res;
+    }
 
 MPS
 densityMatrixApplyMPOImpl(MPO const& K,
@@ -235,10 +380,9 @@ densityMatrixApplyMPOImpl(MPO const& K,
     //Build environment tensors from the left
     if(verbose) print("Building environment tensors...");
     auto E = std::vector<ITensor>(N+1);
-    E[1] = psi(1)*K(1)*Kc(1)*psic(1);
-    for(int j = 2; j < N; ++j)
+    for(int j = 1; j < N; ++j)
         {
-        E[j] = E[j-1]*psi(j)*K(j)*Kc(j)*psic(j);
+        E[j] = envProduct(E[j-1],{psi(j),K(j),Kc(j),psic(j)},rightLinkIndex(psi,j));
         }
     if(verbose) println("done");
 
@@ -285,6 +429,54 @@ densityMatrixApplyMPOImpl(MPO const& K,
     return res;
     }
 
+MPS
+zipUpApplyMPOImpl(MPO const& K,
+                  MPS const& psi,
+                  Args const& args)
+    {
+    auto N = length(psi);
+    if(length(K) != N) Error("Mismatched length in applyMPO method 'ZipUp'");
+
+    auto dargs = Args{"Cutoff",args.getReal("Cutoff",1E-8)};
+    if(args.defined("MaxDim")) dargs.add("MaxDim",args.getInt("MaxDim"));
+    dargs.add("RespectDegenerate",args.getBool("RespectDegenerate",true));
+    auto verbose = args.getBool("Verbose",false);
+    auto normalize = args.getBool("Normalize",false);
+
+    //With psi right orthogonal the untruncated
+    //part to the right of each bond is closer to
+    //an orthonormal basis, making the truncations
+    //closer to optimal
+    auto x = psi;
+    x.position(1);
+
+    auto sites = uniqueSiteInds(K,x);
+    auto res = x;
+
+    //O holds the truncated left part times the
+    //next site of x and K, never more than one
+    //site of the product at a time
+    auto O = x(1)*K(1);
+    Index mid;
+    for(auto j : range1(N-1))
+        {
+        auto A = mid ? ITensor(mid,sites(j)) : ITensor(sites(j));
+        ITensor B;
+        auto spec = denmatDecomp(O,A,B,Fromleft,{dargs,"Tags=",tags(linkIndex(psi,j))});
+        mid = dag(commonIndex(A,B));
+        if(verbose) printfln("  j=%02d truncerr=%.2E dim=%d",j,spec.truncerr(),dim(mid));
+        res.ref(j) = A;
+        O = B*x(j+1)*K(j+1);
+        }
+
+    if(normalize) O /= norm(O);
+    res.ref(N) = O;
+    res.leftLim(N-1);
+    res.rightLim(N+1);
+
+    return res;
+    }
+
 void
 fitApplyMPOImpl(Real fac,
                 MPS const& x,
@@ -306,9 +498,8 @@ fitApplyMPOImpl(Real fac,
     Kx.position(1);
 
     auto E = vector<ITensor>(N+2);
-    E[N] = x(N)*K(N)*Kx(N);
-    for(auto n = N-1; n > 2; --n)
-        E[n] = E[n+1]*x(n)*K(n)*Kx(n);
+    for(auto n = N; n > 2; --n)
+        E[n] = envProduct(E[n+1],{x(n),K(n),Kx(n)},leftLinkIndex(x,n));
 
     for(auto sw : range1(sweeps.nsweep()))
         {
@@ -391,6 +582,68 @@ fitApplyMPOImpl(MPS const& psi,
     fitApplyMPOImpl(1.,psi,K,res,args);
     }
 
+Real
+fitMultMPOImpl(MPO const& A,
+               MPO const& B,
+               MPO& res,
+               Args args)
+    {
+    if(!args.defined("MaxDim")) Error("nmultMPO method 'Fit' requires MaxDim");
+    auto N = length(A);
+    auto nsweep = args.getInt("Nsweep",2);
+    auto verbose = args.getBool("Verbose",false);
+
+    auto zcutoff = std::max(0.,std::min(1E-8,args.getReal("Cutoff")));
+    nmultMPO(A,B,res,{args,"Method=","DensityMatrix",
+                           "Cutoff=",args.getReal("ZipUpCutoff",zcutoff),
+                           "Fidelity=",false});
+
+    // Fit the conjugate of res, with link indices
+    // which can't clash with those of A and B
+    auto C = res;
+    C.dag();
+    C.replaceLinkInds(sim(linkInds(C)));
+    C.position(1);
+
+    auto E = vector<ITensor>(N+2);
+    for(auto n = N; n > 2; --n)
+        E[n] = envProduct(E[n+1],{A(n),B(n),C(n)},leftLinkIndex(A,n));
+
+    for(auto sw : range1(nsweep))
+        {
+        for(int b = 1, ha = 1; ha <= 2; sweepnext(b,ha,N))
+            {
+            auto lwf = (E[b-1] ? E[b-1]*A(b) : A(b));
+            lwf *= B(b);
+            auto rwf = (E[b+2] ? E[b+2]*A(b+1) : A(b+1));
+            rwf *= B(b+1);
+
+            auto wf = lwf*rwf;
+            wf.dag();
+            auto spec = C.svdBond(b,wf,(ha==1?Fromleft:Fromright),args);
+
+            if(verbose)
+                {
+                printfln("Sweep=%d, HS=%d, Bond=(%d,%d) Trunc. err=%.1E, States kept=%s",
+                         sw,ha,b,b+1,spec.truncerr(),showDim(linkIndex(C,b)));
+                }
+
+            if(ha == 1)
+                E[b] = lwf * C(b);
+            else
+                E[b+1] = rwf * C(b+1);
+            }
+        }
+
+    C.dag();
+    res = C;
+
+    if(!args.getBool("Fidelity",false)) return -1;
+    auto fidelity = multMPOFidelity(A,B,res);
+    if(verbose) printfln("Fidelity=%.12f",fidelity);
+    return fidelity;
+    }
+
 void
 applyExpH(MPS const& psi, 
           MPO const& H, 
@@ -505,84 +758,6 @@ applyExpH(MPS const& psi,
 // Deprecated
 //
 
-//
-// For now this is unsupported
-// We can consider bringing it back for example
-// as a way to get a default starting MPS
-// for fitApplyMPOImpl
-//
-
-//void 
-//zipUpApplyMPOImpl(MPS const& psi, 
-//                  MPO const& K, 
-//                  MPS& res, 
-//                  Args const& args)
-//    {
-//    const
-//    bool allow_arb_position = args.getBool("AllowArbPosition",false);
-//
-//    if(&psi == &res)
-//        Error("psi and res must be different MPS instances");
-//
-//    auto N = length(psi);
-//    if(length(K) != N) 
-//        Error("Mismatched N in ApplyMPO() ZipUp method");
-//
-//    if(!itensor::isOrtho(psi) || itensor::orthoCenter(psi) != 1)
-//        Error("Ortho center of psi must be site 1");
-//
-//    if(!allow_arb_position && (!itensor::isOrtho(K) || itensor::orthoCenter(K) != 1))
-//        Error("Ortho center of K must be site 1");
-//
-//#ifdef DEBUG
-//    checkQNs(psi);
-//    checkQNs(K);
-//    /*
-//    cout << "Checking divergence in zip" << endl;
-//    for(int i = 1; i <= N; i++)
-//	div(psi(i));
-//    for(int i = 1; i <= N; i++)
-//	div(K(i));
-//    cout << "Done Checking divergence in zip" << endl;
-//    */
-//#endif
-//
-//    res = psi; 
-//    res.replaceTags("0","4","Link");
-//    res.replaceTags("0","1","Site");
-//
-//    ITensor clust,nfork;
-//    vector<int> midsize(N);
-//    int maxdim = 1;
-//    for(int i = 1; i < N; i++)
-//        {
-//        if(i == 1) { clust = psi(i) * K(i); }
-//        else { clust = nfork * (psi(i) * K(i)); }
-//        if(i == N-1) break; //No need to SVD for i == N-1
-//
-//        Index oldmid = linkIndex(res,i); assert(oldmid.dir() == Out);
-//        nfork = ITensor(linkIndex(psi,i),linkIndex(K,i-1),oldmid);
-//        //if(clust.iten_size() == 0)	// this product gives 0 !!
-//	    //throw ResultIsZero("clust.iten size == 0");
-//        denmatDecomp(clust, res.ref(i), nfork,Fromleft,args);
-//        Index mid = commonIndex(res(i),nfork);
-//        //assert(mid.dir() == In);
-//        mid.dag();
-//        midsize[i] = dim(mid);
-//        maxdim = std::max(midsize[i],maxdim);
-//        assert(linkIndex(res,i+1).dir() == Out);
-//        res.ref(i+1) = ITensor(mid,prime(res.sites()(i+1)),linkIndex(res,i+1));
-//        }
-//    nfork = clust * psi(N) * K(N);
-//    //if(nfork.iten_size() == 0)	// this product gives 0 !!
-//    //throw ResultIsZero("nfork.iten size == 0");
-//
-//    res.svdBond(N-1,nfork,Fromright,args);
-//    res.noPrime("Link");
-//    res.replaceTags("1","0","Site");
-//    res.position(1);
-//    } //void zipUpApplyMPOImpl
-
 //
 // These versions calculate |res> = |psiA> + mpofac*H*|psiB>
 // Currently they are unsupported
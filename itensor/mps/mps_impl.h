@@ -47,6 +47,12 @@ svdBond(int b, ITensor const& AA, Direction dir,
     // be put back onto the newly introduced link index
     auto original_link_tags = tags(linkIndex(*this,b));
 
+    //A truncated SVD starts from the current bond dimension
+    if(args.getBool("RandomSVD",false) && not args.defined("RankGuess"))
+        {
+        args.add("RankGuess",dim(linkIndex(*this,b)));
+        }
+
     if(usesvd || (noise == 0 && cutoff < 1E-12))
         {
         //Need high accuracy, use svd which calls the
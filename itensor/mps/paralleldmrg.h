@@ -0,0 +1,361 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_PARALLELDMRG_H
+#define __ITENSOR_PARALLELDMRG_H
+
+#include <memory>
+#include "itensor/util/parallel.h"
+#include "itensor/mps/dmrg.h"
+
+namespace itensor {
+
+//
+// Real-space parallel DMRG
+// (E.M. Stoudenmire and S.R. White, PRB 87, 155137 (2013))
+//
+// Each MPI node owns a contiguous block of sites of
+// the chain and sweeps it with its own LocalMPO, using
+// edge tensors received from the neighboring nodes.
+// Even nodes sweep right while odd nodes sweep left,
+// then the reverse, so each pair of neighboring blocks
+// meets once per sweep at the bond b between them.
+// There the left node optimizes the wavefunction
+//
+//   psi(b) * V * psi(b+1)
+//
+// where V holds the inverse singular values of bond b,
+// and the new psi(b+1) and edge tensors are exchanged
+// through a MailBox. The inverse is regularized as
+// s/(s^2+eps^2) with eps set by the "InverseEps" arg
+// (default 1E-3), since the exact 1/s amplifies
+// the noise term and truncation errors.
+//
+// All nodes must call parallelDMRG with the same sweeps
+// and args; psi and H are taken from the first node.
+// Each block needs at least two sites. On return psi
+// (on every node) is the optimized MPS collected from
+// all blocks, and <psi|H|psi> is returned.
+//
+Real
+parallelDMRG(MPS & psi,
+             MPO const& H0,
+             Sweeps const& sweeps,
+             Environment const& env,
+             Args args = Args::global());
+
+namespace detail {
+
+//Block of sites of each node: node r
+//owns sites first[r],...,first[r+1]-1
+std::vector<int> inline
+parallelDMRGBlocks(int N, int nnodes)
+    {
+    if(N < 2*nnodes)
+        {
+        Error(format("parallelDMRG: %d sites are too few for %d nodes",N,nnodes));
+        }
+    auto first = std::vector<int>(nnodes+1);
+    for(auto r : range(nnodes+1)) first[r] = 1+(r*N)/nnodes;
+    return first;
+    }
+
+//Edge tensor of sites 1,...,j from L,
+//the edge tensor of sites 1,...,j-1
+ITensor inline
+extendEdgeL(ITensor const& L, MPS const& psi, MPO const& H, int j)
+    {
+    auto nL = L ? L*psi(j) : psi(j);
+    nL *= H(j);
+    nL *= dag(prime(psi(j)));
+    return nL;
+    }
+
+//Edge tensor of sites j,...,N from R,
+//the edge tensor of sites j+1,...,N
+ITensor inline
+extendEdgeR(ITensor const& R, MPS const& psi, MPO const& H, int j)
+    {
+    auto nR = R ? R*psi(j) : psi(j);
+    nR *= H(j);
+    nR *= dag(prime(psi(j)));
+    return nR;
+    }
+
+//Regularized inverse s/(s^2+eps^2) of the singular
+//values S, so that (A*S)*invertSingularValues(S)*(S*B)
+//is close to A*S*B without amplifying small s
+ITensor inline
+invertSingularValues(ITensor S, Real eps)
+    {
+    S.apply([eps](Real s) { return s/(s*s+eps*eps); });
+    return dag(S);
+    }
+
+//On the first node, bring psi into the forms
+//  A_1 ... A_j-1 C_j B_j+1 ... B_N
+//for every j (psiA holds the A's, psiB the B's),
+//and compute V at each bond between blocks;
+//then send all of these to the other nodes
+void inline
+parallelDMRGInit(Environment const& env,
+                 MPS const& psi,
+                 std::vector<int> const& first,
+                 MPS & psiA,
+                 MPS & psiB,
+                 std::vector<ITensor> & C,
+                 std::vector<ITensor> & V,
+                 Real eps)
+    {
+    auto N = length(psi);
+    C.assign(N+1,ITensor());
+    V.assign(N+1,ITensor());
+    if(env.firstNode())
+        {
+        psiB = psi;
+        psiB.position(1);
+        psiA = psiB;
+        C.at(1) = psiB(1);
+        auto atblock = std::vector<bool>(N+1,false);
+        for(auto r : range(1ul,first.size()-1)) atblock.at(first[r]-1) = true;
+        for(auto j : range1(N-1))
+            {
+            auto ltags = tags(linkIndex(psiB,j));
+            auto U = ITensor(uniqueInds(C[j],psiB(j+1)));
+            ITensor S,W;
+            svd(C[j],U,S,W,{"LeftTags=",ltags,"RightTags=",addTags(ltags,"V")});
+            psiA.ref(j) = U;
+            C.at(j+1) = S*W*psiB(j+1);
+            //C[j] = U*S*W with W connecting to psiB(j+1),
+            //so V = W^dag*S^-1 gives C[j]*V*C[j+1] == U*C[j+1]
+            if(atblock.at(j)) V.at(j) = dag(W)*invertSingularValues(S,eps);
+            }
+        psiA.ref(N) = C.at(N);
+        }
+    broadcast(env,psiA,psiB,C,V);
+    }
+
+//Sweep sites f,...,l of psi in direction dir
+//(Fromleft starting with the orthogonality center
+//at site f, Fromright with it at site l)
+Real inline
+parallelDMRGSweepBlock(MPS & psi,
+                       LocalMPO & PH,
+                       int f,
+                       int l,
+                       Direction dir,
+                       Args const& args)
+    {
+    Real energy = NAN;
+    if(dir == Fromleft)
+        {
+        psi.leftLim(f-1);
+        psi.rightLim(f+1);
+        }
+    else
+        {
+        psi.leftLim(l-1);
+        psi.rightLim(l+1);
+        }
+    for(int n = 0; n < l-f; ++n)
+        {
+        auto b = (dir == Fromleft) ? f+n : l-1-n;
+        PH.position(b,psi);
+        auto phi = psi(b)*psi(b+1);
+        energy = davidson(PH,phi,args);
+        psi.svdBond(b,phi,dir,PH,args);
+        }
+    return energy;
+    }
+
+//Optimize bond b at the right end of this node's
+//block, with psi(b+1) and the edge tensor of sites
+//> b+1 received from the node to the right
+Real inline
+parallelDMRGBondLeft(MailBox & box,
+                     MPS & psi,
+                     MPO const& H,
+                     LocalMPO & PH,
+                     int b,
+                     ITensor & V,
+                     Args const& args)
+    {
+    ITensor C,RE;
+    box.receive(C);
+    box.receive(RE);
+    auto LE = extendEdgeL(PH.L(),psi,H,b-1);
+
+    auto PB = LocalMPO(H,LE,b-1,RE,b+2,args);
+    PB.position(b,psi);
+    auto phi = psi(b)*V*C;
+    auto energy = davidson(PB,phi,args);
+
+    auto ltags = tags(commonIndex(V,C));
+    auto A = ITensor(uniqueInds(psi(b),V));
+    ITensor S,B;
+    //V needs the singular values, so no noise term here
+    svd(phi,A,S,B,{args,"Noise=",0.,"LeftTags=",ltags,"RightTags=",addTags(ltags,"V")});
+    S /= norm(S);
+    V = invertSingularValues(S,args.getReal("InverseEps"));
+
+    psi.ref(b) = A;
+    box.send(S*B);
+    box.send(extendEdgeL(LE,psi,H,b));
+
+    psi.ref(b) = A*S;
+    psi.ref(b+1) = B;
+    PH.R(b,extendEdgeR(RE,psi,H,b+1));
+    return energy;
+    }
+
+//Counterpart of parallelDMRGBondLeft on the node
+//whose block starts at site f = b+1
+void inline
+parallelDMRGBondRight(MailBox & box,
+                      MPS & psi,
+                      MPO const& H,
+                      LocalMPO & PH,
+                      int f)
+    {
+    box.send(psi(f));
+    box.send(extendEdgeR(PH.R(),psi,H,f+1));
+
+    ITensor C,LE;
+    box.receive(C);
+    box.receive(LE);
+    psi.ref(f) = C;
+    PH.L(f,LE);
+    }
+
+} //namespace detail
+
+Real inline
+parallelDMRG(MPS & psi,
+             MPO const& H0,
+             Sweeps const& sweeps,
+             Environment const& env,
+             Args args)
+    {
+    //Index ids differ between nodes unless the
+    //tensors were made on one node and sent to all
+    auto H = H0;
+    broadcast(env,H);
+
+    const bool silent = args.getBool("Silent",false);
+    if(silent)
+        {
+        args.add("Quiet",true);
+        args.add("DebugLevel",0);
+        }
+    const bool quiet = args.getBool("Quiet",false);
+    args.add("DebugLevel",args.getInt("DebugLevel",(quiet ? 0 : 1)));
+    args.add("RespectDegenerate",args.getBool("RespectDegenerate",true));
+    args.add("DoNormalize",true);
+    args.add("InverseEps",args.getReal("InverseEps",1E-3));
+
+    const int N = length(psi);
+    const int rank = env.rank(),
+              nnodes = env.nnodes();
+    auto first = detail::parallelDMRGBlocks(N,nnodes);
+    auto f = first.at(rank),
+         l = first.at(rank+1)-1;
+
+    MPS psiA,
+        psiB;
+    std::vector<ITensor> C,
+                         V;
+    detail::parallelDMRGInit(env,psi,first,psiA,psiB,C,V,args.getReal("InverseEps"));
+
+    //Orthogonality center of this node's copy of psi
+    //starts at the left end of the block on even nodes,
+    //the right end on odd nodes
+    auto c = (rank%2 == 0) ? f : l;
+    for(auto j : range1(N))
+        {
+        if(j < c)       psi.ref(j) = psiA(j);
+        else if(j == c) psi.ref(j) = C.at(j);
+        else            psi.ref(j) = psiB(j);
+        }
+    //V of the bond at the right end of the block
+    auto Vr = V.at(l);
+
+    ITensor LE,
+            RE;
+    for(int j = 1; j < f; ++j) LE = detail::extendEdgeL(LE,psi,H,j);
+    for(int j = N; j > l; --j) RE = detail::extendEdgeR(RE,psi,H,j);
+    auto PH = LocalMPO(H,LE,f-1,RE,l+1,args);
+
+    std::unique_ptr<MailBox> lbox,
+                             rbox;
+    if(rank > 0)        lbox = std::make_unique<MailBox>(env,rank-1);
+    if(rank < nnodes-1) rbox = std::make_unique<MailBox>(env,rank+1);
+
+    Real energy = NAN;
+    for(int sw = 1; sw <= sweeps.nsweep(); ++sw)
+        {
+        cpu_time sw_time;
+        args.add("Sweep",sw);
+        args.add("NSweep",sweeps.nsweep());
+        args.add("Cutoff",sweeps.cutoff(sw));
+        args.add("MinDim",sweeps.mindim(sw));
+        args.add("MaxDim",sweeps.maxdim(sw));
+        args.add("Noise",sweeps.noise(sw));
+        args.add("MaxIter",sweeps.niter(sw));
+
+        for(int half = 0; half < 2; ++half)
+            {
+            auto toright = ((rank+half)%2 == 0);
+            energy = detail::parallelDMRGSweepBlock(psi,PH,f,l,(toright ? Fromleft : Fromright),args);
+            if(toright && rbox)
+                {
+                energy = detail::parallelDMRGBondLeft(*rbox,psi,H,PH,l,Vr,args);
+                }
+            else if(!toright && lbox)
+                {
+                detail::parallelDMRGBondRight(*lbox,psi,H,PH,f);
+                }
+            }
+
+        if(!quiet && env.firstNode())
+            {
+            auto sm = sw_time.sincemark();
+            printfln("    Sweep %d/%d: energy (node 0) = %.14f, CPU time = %s (Wall time = %s)",
+                     sw,sweeps.nsweep(),energy,showtime(sm.time),showtime(sm.wall));
+            }
+        }
+
+    //Collect the blocks on the first node,
+    //multiplying V into the last site of each
+    auto T = std::vector<ITensor>();
+    for(int j = f; j <= l; ++j) T.push_back(psi(j));
+    if(rbox) T.back() *= Vr;
+    gatherVector(env,T);
+    if(env.firstNode())
+        {
+        for(auto j : range1(N)) psi.ref(j) = T.at(j-1);
+        psi.leftLim(0);
+        psi.rightLim(N+1);
+        psi.position(1);
+        psi.normalize();
+        energy = inner(psi,H,psi);
+        }
+    broadcast(env,psi,energy);
+
+    return energy;
+    }
+
+} //namespace itensor
+
+#endif
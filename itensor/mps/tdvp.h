@@ -0,0 +1,322 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_TDVP_H
+#define __ITENSOR_TDVP_H
+
+#include "itensor/mps/dmrg.h"
+
+namespace itensor {
+
+//
+// Time-dependent variational principle (TDVP)
+// (J. Haegeman et al., PRB 94, 165116 (2016))
+//
+// Each sweep evolves psi by exp(t*H), so pass
+// t = -i*dt for a real time step dt, or t = -dt for
+// an imaginary time step. Each half sweep evolves
+// the local wavefunctions forward by t/2 and the
+// ones between them (which the sweep moves past)
+// back by t/2, giving a second order integrator.
+// Unlike gateTEvol, H can be any MPO, including
+// long-range AutoMPO Hamiltonians.
+//
+// The local exponentials are computed by applyExp.
+//
+// Args:
+// o "NumCenter" - 2 (default) evolves two sites at
+//   a time so the bond dimension can grow, truncating
+//   with the cutoff and maxdim of the sweeps. 1 evolves
+//   one site at a time, keeping the bond dimensions
+//   of psi fixed.
+// o "Normalize" - normalize psi after each step
+//   (default true)
+// o "MaxKrylov" - maximum number of Krylov vectors
+//   applyExp uses for each local exponential
+//   (default 30)
+// o "ErrGoal" - error goal of applyExp (default 1E-12)
+// o "Quiet", "Silent" and "DebugLevel" as for dmrg
+//
+// Returns the energy <psi|H|psi> of the last step.
+//
+Real
+tdvp(MPS & psi,
+     MPO const& H,
+     Cplx t,
+     Sweeps const& sweeps,
+     Args const& args = Args::global());
+
+Real
+tdvp(MPS & psi,
+     MPO const& H,
+     Cplx t,
+     Sweeps const& sweeps,
+     DMRGObserver & obs,
+     Args args = Args::global());
+
+namespace detail {
+
+//Effective Hamiltonian of the tensor on the bond
+//between the environment L (of the sites to its left)
+//and R (of the sites to its right)
+struct TDVPBondOp
+    {
+    ITensor const& L;
+    ITensor const& R;
+
+    TDVPBondOp(ITensor const& L_, ITensor const& R_) : L(L_), R(R_) { }
+
+    void
+    product(ITensor const& phi, ITensor & phip) const
+        {
+        phip = L*phi;
+        phip *= R;
+        phip.noPrime();
+        }
+    };
+
+//Environment E extended by the site tensor A
+//(as LocalMPO::makeL and makeR do)
+ITensor inline
+extendEnv(ITensor const& E, ITensor const& A, ITensor const& W)
+    {
+    auto nE = E ? E*A : A;
+    nE *= W;
+    nE *= dag(prime(A));
+    return nE;
+    }
+
+//One-site TDVP step: evolve site j = b (going right)
+//or j = b+1 (going left) forward by t, split off the
+//tensor on bond b and evolve it back by t
+Spectrum inline
+tdvpSite(MPS & psi,
+         LocalMPO & PH,
+         int b,
+         Cplx t,
+         Direction dir,
+         Real & energy,
+         Args const& args)
+    {
+    auto j = (dir == Fromleft ? b : b+1);
+    PH.position(j,psi);
+    auto phi = psi(j);
+    energy = applyExp(PH,phi,t,args);
+    if(args.getBool("Normalize")) phi /= norm(phi);
+
+    auto ltags = tags(linkIndex(psi,b));
+    ITensor U,S,V;
+    if(dir == Fromleft) U = ITensor(uniqueInds(phi,psi(b+1)));
+    else                U = ITensor(commonIndex(phi,psi(b)));
+    auto spec = svd(phi,U,S,V,{"Truncate",false,
+                               "LeftTags=",(dir == Fromleft ? ltags : addTags(ltags,"U")),
+                               "RightTags=",(dir == Fromleft ? addTags(ltags,"V") : ltags)});
+
+    if(dir == Fromleft)
+        {
+        auto C = S*V;
+        auto L = extendEnv(PH.L(),U,PH.H()(j));
+        applyExp(detail::TDVPBondOp(L,PH.R()),C,-t,args);
+        if(args.getBool("Normalize")) C /= norm(C);
+        psi.ref(b) = U;
+        psi.ref(b+1) *= C;
+        psi.leftLim(b);
+        psi.rightLim(b+2);
+        }
+    else
+        {
+        auto C = U*S;
+        auto R = extendEnv(PH.R(),V,PH.H()(j));
+        applyExp(detail::TDVPBondOp(PH.L(),R),C,-t,args);
+        if(args.getBool("Normalize")) C /= norm(C);
+        psi.ref(b+1) = V;
+        psi.ref(b) *= C;
+        psi.leftLim(b-1);
+        psi.rightLim(b+1);
+        }
+    return spec;
+    }
+
+//Evolve the one-site wavefunction at site j
+//forward by t (at the ends of the sweep)
+void inline
+tdvpEndSite(MPS & psi,
+            LocalMPO & PH,
+            int j,
+            Cplx t,
+            Real & energy,
+            Args const& args)
+    {
+    PH.position(j,psi);
+    auto phi = psi(j);
+    energy = applyExp(PH,phi,t,args);
+    if(args.getBool("Normalize")) phi /= norm(phi);
+    psi.ref(j) = phi;
+    }
+
+//Two-site TDVP step: evolve sites b,b+1 forward by t,
+//then (unless at the end of the half sweep) evolve
+//the new orthogonality center back by t
+Spectrum inline
+tdvpBond(MPS & psi,
+         LocalMPO & PH,
+         int b,
+         Cplx t,
+         Direction dir,
+         Real & energy,
+         Args const& args)
+    {
+    auto N = length(psi);
+    PH.position(b,psi);
+    auto phi = psi(b)*psi(b+1);
+    energy = applyExp(PH,phi,t,args);
+    auto spec = psi.svdBond(b,phi,dir,PH,args);
+
+    auto j = (dir == Fromleft ? b+1 : b);
+    if((dir == Fromleft && j < N) || (dir == Fromright && j > 1))
+        {
+        PH.numCenter(1);
+        PH.position(j,psi);
+        auto phi1 = psi(j);
+        applyExp(PH,phi1,-t,args);
+        if(args.getBool("Normalize")) phi1 /= norm(phi1);
+        psi.ref(j) = phi1;
+        PH.numCenter(2);
+        }
+    return spec;
+    }
+
+} //namespace detail
+
+Real inline
+tdvp(MPS & psi,
+     MPO const& H,
+     Cplx t,
+     Sweeps const& sweeps,
+     Args const& args)
+    {
+    DMRGObserver obs(psi,args);
+    return tdvp(psi,H,t,sweeps,obs,args);
+    }
+
+Real inline
+tdvp(MPS & psi,
+     MPO const& H,
+     Cplx t,
+     Sweeps const& sweeps,
+     DMRGObserver & obs,
+     Args args)
+    {
+    const bool silent = args.getBool("Silent",false);
+    if(silent)
+        {
+        args.add("Quiet",true);
+        args.add("PrintEigs",false);
+        args.add("NoMeasure",true);
+        args.add("DebugLevel",0);
+        }
+    const bool quiet = args.getBool("Quiet",false);
+    args.add("DebugLevel",args.getInt("DebugLevel",(quiet ? 0 : 1)));
+    args.add("Normalize",args.getBool("Normalize",true));
+    args.add("DoNormalize",args.getBool("Normalize"));
+    args.add("RespectDegenerate",args.getBool("RespectDegenerate",true));
+    args.add("MaxIter",args.getInt("MaxKrylov",30));
+
+    const int numCenter = args.getInt("NumCenter",2);
+    if(numCenter != 1 && numCenter != 2)
+        {
+        Error("tdvp: NumCenter must be 1 or 2");
+        }
+
+    PROFILE_SCOPE("tdvp")
+    const int N = length(psi);
+    Real energy = NAN;
+
+    psi.position(1);
+    auto PH = LocalMPO(H,{args,"NumCenter",numCenter});
+
+    for(int sw = 1; sw <= sweeps.nsweep(); ++sw)
+        {
+        PROFILE_SCOPE("sweep")
+        cpu_time sw_time;
+        args.add("Sweep",sw);
+        args.add("NSweep",sweeps.nsweep());
+        args.add("Cutoff",sweeps.cutoff(sw));
+        args.add("MinDim",sweeps.mindim(sw));
+        args.add("MaxDim",sweeps.maxdim(sw));
+        args.add("Noise",sweeps.noise(sw));
+
+        for(int b = 1, ha = 1; ha <= 2; sweepnext(b,ha,N))
+            {
+            if(!quiet)
+                {
+                printfln("Sweep=%d, HS=%d, Bond=%d/%d",sw,ha,b,(N-1));
+                }
+
+            PROFILE_SCOPE("bond")
+            auto dir = (ha==1 ? Fromleft : Fromright);
+            Spectrum spec;
+            if(numCenter == 1)
+                {
+                spec = detail::tdvpSite(psi,PH,b,t/2.,dir,energy,args);
+                //The sites at the ends are not split off
+                //from, so finish evolving them here
+                if(ha == 1 && b == N-1) detail::tdvpEndSite(psi,PH,N,t/2.,energy,args);
+                if(ha == 2 && b == 1)   detail::tdvpEndSite(psi,PH,1,t/2.,energy,args);
+                }
+            else
+                {
+                spec = detail::tdvpBond(psi,PH,b,t/2.,dir,energy,args);
+                }
+
+            if(!quiet)
+                {
+                printfln("    Truncated to Cutoff=%.1E, Min_dim=%d, Max_dim=%d",
+                          sweeps.cutoff(sw),
+                          sweeps.mindim(sw),
+                          sweeps.maxdim(sw) );
+                printfln("    Trunc. err=%.1E, States kept: %s",
+                         spec.truncerr(),
+                         showDim(linkIndex(psi,b)) );
+                }
+
+            obs.lastSpectrum(spec);
+
+            args.add("AtBond",b);
+            args.add("HalfSweep",ha);
+            args.add("Energy",energy);
+            args.add("Truncerr",spec.truncerr());
+
+            obs.measure(args);
+
+            } //for loop over b
+
+        if(!silent)
+            {
+            auto sm = sw_time.sincemark();
+            printfln("    Sweep %d/%d CPU time = %s (Wall time = %s)",
+                      sw,sweeps.nsweep(),showtime(sm.time),showtime(sm.wall));
+            }
+
+        if(obs.checkDone(args)) break;
+
+        } //for loop over sw
+
+    return energy;
+    }
+
+} //namespace itensor
+
+#endif
@@ -19,6 +19,7 @@
 #include "itensor/mps/mpo.h"
 #include "itensor/mps/bondgate.h"
 #include "itensor/mps/TEvolObserver.h"
+#include "itensor/util/threadpool.h"
 
 namespace itensor {
 
@@ -29,6 +30,19 @@ namespace itensor {
 //
 // Arguments recognized:
 //    "Verbose": if true, print useful information to stdout
+//    "Parallel": if true, keep psi in Vidal (Gamma-Lambda)
+//                form while applying the gates, so that each
+//                layer of consecutive gates acting on disjoint
+//                pairs of neighboring sites i1,i1+1 is applied
+//                concurrently on "NThread" threads (default 1).
+//                Order the gates in even/odd layers to use this.
+//                Each gate is truncated using the Schmidt values
+//                of its bond in the Vidal form, which are exact
+//                up to the truncation error of earlier gates.
+//                Gates of type tImag or Custom do not preserve
+//                the Vidal form, so gate lists containing any
+//                are applied serially as without "Parallel"
+//                (a warning is printed the first time).
 //
 template <class Iterable>
 Real
@@ -52,6 +66,175 @@ gateTEvol(Iterable const& gatelist,
 // Implementations
 //
 
+namespace detail {
+
+//Bring psi into right canonical (Vidal) form
+//psi(j) = Gamma_j*Lambda_j, returning Lambda_b
+//(the singular values of bond b) as Lam[b]
+std::vector<ITensor> inline
+toVidal(MPS & psi,
+        Args const& args)
+    {
+    auto N = length(psi);
+    auto Lam = std::vector<ITensor>(N);
+    psi.position(N);
+    for(int b = N-1; b >= 1; --b)
+        {
+        auto ltags = tags(linkIndex(psi,b));
+        auto phi = psi(b)*psi(b+1);
+        auto U = ITensor(uniqueInds(psi(b),psi(b+1)));
+        ITensor S,V;
+        svd(phi,U,S,V,{args,"RightTags=",ltags});
+        psi.ref(b) = U*S;
+        psi.ref(b+1) = V;
+        Lam.at(b) = S;
+        }
+    psi.leftLim(0);
+    psi.rightLim(2);
+    return Lam;
+    }
+
+//Apply gate G to the tensors Ai, Ai1 of sites i,i+1
+//of an MPS in Vidal form, using Lambda_i-1 (Lleft) to
+//weight the left bond (Hastings, J. Math. Phys. 50,
+//095207 (2009)) so that no singular values are
+//inverted. Sets A, B and S to the new tensors of
+//sites i, i+1 and Lambda_i.
+Spectrum inline
+vidalGate(ITensor const& Ai,
+          ITensor const& Ai1,
+          ITensor const& Lleft,
+          ITensor const& G,
+          TagSet const& ltags,
+          ITensor & A,
+          ITensor & B,
+          ITensor & S,
+          Args const& args)
+    {
+    auto phi = Ai*Ai1*G;
+    phi.replaceTags("Site,1","Site,0");
+    auto theta = Lleft ? Lleft*phi : phi;
+    auto U = ITensor(uniqueInds(theta,Ai1));
+    auto spec = svd(theta,U,S,B,{args,"RightTags=",ltags});
+    A = phi*dag(B);
+    return spec;
+    }
+
+//Whether every gate is of type tReal or Swap,
+//so applying it preserves the Vidal form of psi
+template <class Iterable>
+bool
+isUnitary(Iterable const& gatelist)
+    {
+    for(auto& g : gatelist)
+        {
+        if(g.type() != BondGate::tReal && g.type() != BondGate::Swap) return false;
+        }
+    return true;
+    }
+
+//Requires isUnitary(gatelist)
+template <class Iterable>
+Real
+gateTEvolParallel(Iterable const& gatelist,
+                  int nt,
+                  Real tstep,
+                  Real ttotal,
+                  MPS & psi,
+                  Observer& obs,
+                  Args args)
+    {
+    using GateT = typename std::decay<decltype(*gatelist.begin())>::type;
+    const bool do_normalize = args.getBool("Normalize",true);
+    const int nthread = args.getInt("NThread",1);
+
+    //Layers of consecutive gates on disjoint sites
+    auto layers = std::vector<std::vector<GateT const*>>();
+    auto used = std::vector<bool>(length(psi)+2,false);
+    for(auto& g : gatelist)
+        {
+        if(g.i2() != g.i1()+1)
+            {
+            Error("gateTEvol: \"Parallel\" requires gates acting on sites i1,i1+1");
+            }
+        if(layers.empty() || used.at(g.i1()) || used.at(g.i2()))
+            {
+            layers.emplace_back();
+            used.assign(used.size(),false);
+            }
+        layers.back().push_back(&g);
+        used.at(g.i1()) = true;
+        used.at(g.i2()) = true;
+        }
+
+    auto Lam = toVidal(psi,args);
+    Real tot_norm = norm(psi);
+
+    Real tsofar = 0;
+    for(auto tt : range1(nt))
+        {
+        for(auto& layer : layers)
+            {
+            //Reading psi is not thread safe,
+            //so collect the tensors first
+            auto n = layer.size();
+            auto A = std::vector<ITensor>(n),
+                 B = std::vector<ITensor>(n),
+                 S = std::vector<ITensor>(n);
+            auto ltags = std::vector<TagSet>(n);
+            for(auto k : range(n))
+                {
+                auto i = layer[k]->i1();
+                A[k] = psi(i);
+                B[k] = psi(i+1);
+                ltags[k] = tags(linkIndex(psi,i));
+                }
+            threadPool(nthread).run(n,[&](long k)
+                {
+                auto i = layer[k]->i1();
+                auto Ai = A[k],
+                     Ai1 = B[k];
+                vidalGate(Ai,Ai1,(i > 1 ? Lam.at(i-1) : ITensor()),layer[k]->gate(),
+                          ltags[k],A[k],B[k],S[k],args);
+                },nthread);
+            for(auto k : range(n))
+                {
+                auto i = layer[k]->i1();
+                psi.ref(i) = A[k];
+                psi.ref(i+1) = B[k];
+                Lam.at(i) = S[k];
+                }
+            }
+
+        psi.leftLim(0);
+        psi.rightLim(2);
+
+        if(do_normalize)
+            {
+            //Once gates are truncated the Vidal form is only
+            //approximate, so psi(1) does not give the norm
+            auto nrm = std::sqrt(std::abs(innerC(psi,psi)));
+            psi.ref(1) /= nrm;
+            tot_norm *= nrm;
+            }
+
+        tsofar += tstep;
+
+        args.add("TimeStepNum",tt);
+        args.add("Time",tsofar);
+        args.add("TotalTime",ttotal);
+        obs.measure(args);
+        }
+
+    //Restore an exact orthogonality center,
+    //for the same reason
+    psi.rightLim(length(psi)+1);
+    psi.position(1);
+    return tot_norm;
+    }
+
+} //namespace detail
+
 template <class Iterable>
 Real
 gateTEvol(Iterable const& gatelist, 
@@ -75,6 +258,27 @@ gateTEvol(Iterable const& gatelist,
         printfln("Taking %d steps of timestep %.5f, total time %.5f",nt,tstep,ttotal);
         }
 
+    auto parallel = args.getBool("Parallel",false);
+    if(parallel && !detail::isUnitary(gatelist))
+        {
+        static auto warned = false;
+        if(!warned)
+            {
+            println("Warning: gateTEvol \"Parallel\" needs gates of type tReal or Swap, applying gates serially");
+            warned = true;
+            }
+        parallel = false;
+        }
+    if(parallel)
+        {
+        auto tot_norm = detail::gateTEvolParallel(gatelist,nt,tstep,ttotal,psi,obs,args);
+        if(verbose)
+            {
+            printfln("\nTotal time evolved = %.5f\n",nt*tstep);
+            }
+        return tot_norm;
+        }
+
     psi.position(gatelist.front().i1());
     Real tot_norm = norm(psi);
 
@@ -19,6 +19,7 @@
 #include "itensor/decomp.h"
 #include "itensor/util/print_macro.h"
 #include "itensor/itdata/qutil.h"
+#include "itensor/util/threadpool.h"
 
 namespace itensor {
 
@@ -36,6 +37,82 @@ using std::sqrt;
 using std::move;
 using std::tie;
 
+//Settings of the truncated SVD done when
+//"RandomSVD" is true (see decomp.h)
+struct TruncSVD
+    {
+    bool on = false;
+    long rank = 0,
+         maxdim = 0,
+         oversample = 0,
+         npower = 0;
+    Real tol = 0,
+         cutoff = 0;
+    bool absoluteCutoff = false,
+         doRelCutoff = true;
+
+    TruncSVD(Args const& args,
+             bool do_truncate,
+             long maxdim_,
+             long mindim,
+             Real cutoff_,
+             bool absoluteCutoff_,
+             bool doRelCutoff_)
+      : on(do_truncate && args.getBool("RandomSVD",false)),
+        maxdim(maxdim_),
+        oversample(args.getInt("Oversample",10)),
+        npower(args.getInt("PowerIters",2)),
+        tol(args.getReal("RandomSVDTol",1E-6)),
+        cutoff(cutoff_),
+        absoluteCutoff(absoluteCutoff_),
+        doRelCutoff(doRelCutoff_)
+        {
+        rank = std::min(maxdim,args.getInt("RankGuess",maxdim));
+        rank = std::max(rank,std::max(mindim,1l));
+        }
+
+    //Number of singular values to compute
+    //for a block of size nr x nc
+    long
+    nsv(long nr, long nc) const
+        {
+        auto n = std::min(nr,nc);
+        return on ? std::min(n,rank+oversample) : n;
+        }
+
+    //Returns true if a result leaving out weight tail
+    //(of total weight total) is accurate enough. If not,
+    //increases the rank or falls back to the full SVD.
+    bool
+    accept(Real tail, Real total)
+        {
+        if(not on || tail <= 0) return true;
+        auto limit = tol*total;
+        if(rank < maxdim)
+            {
+            //Singular values left out must all
+            //be ones the cutoff would discard
+            auto cut = absoluteCutoff ? 0. : (doRelCutoff ? cutoff*total : cutoff);
+            limit = std::min(limit,cut);
+            }
+        if(tail <= limit) return true;
+        if(rank < maxdim) rank = std::min(maxdim,2*rank);
+        else              on = false;
+        return false;
+        }
+    };
+
+SVDMethod static
+getSVDMethod(Args const& args)
+    {
+    auto method = args.getString("SVDMethod","recursive");
+    if(method == "recursive") return SVDRecursive;
+    if(method == "gesdd") return SVDGesdd;
+    if(method == "gesvd") return SVDGesvd;
+    Error(format("Unknown SVDMethod \"%s\" (must be recursive, gesdd or gesvd)",method));
+    return SVDRecursive;
+    }
+
 template<typename T>
 Spectrum
 svdImpl(ITensor const& A,
@@ -46,6 +123,7 @@ svdImpl(ITensor const& A,
         ITensor & V,
         Args args)
     {
+    PROFILE_SCOPE("svd")
     if( args.defined("Minm") )
       {
       if( args.defined("MinDim") )
@@ -74,6 +152,7 @@ svdImpl(ITensor const& A,
 
     auto do_truncate = args.getBool("Truncate");
     auto thresh = args.getReal("SVDThreshold",1E-3);
+    auto method = getSVDMethod(args);
     auto cutoff = args.getReal("Cutoff",MIN_CUT);
     auto maxdim = args.getInt("MaxDim",MAX_DIM);
     auto mindim = args.getInt("MinDim",1);
@@ -86,16 +165,19 @@ svdImpl(ITensor const& A,
 
     if(not hasQNs(A))
         {
-        SCOPED_TIMER(7);
 
         auto M = toMatRefc<T>(A,uI,vI);
 
         Mat<T> UU,VV;
         Vector DD;
 
-        TIMER_START(6)
-        SVD(M,UU,DD,VV,thresh);
-        TIMER_STOP(6)
+        auto tsvd = TruncSVD(args,do_truncate,maxdim,mindim,cutoff,absoluteCutoff,doRelCutoff);
+        Real tail = 0;
+        while(true)
+            {
+            tail = randomSVD(M,UU,DD,VV,tsvd.nsv(nrows(M),ncols(M)),tsvd.npower,thresh,method);
+            if(tsvd.accept(tail,sqr(norm(DD))+tail)) break;
+            }
 
         //conjugate VV so later we can just do
         //U*D*V to reconstruct ITensor A:
@@ -107,8 +189,12 @@ svdImpl(ITensor const& A,
         Vector probs;
         if(do_truncate || show_eigs)
             {
-            probs = DD;
-            for(auto j : range(probs)) probs(j) = sqr(probs(j));
+            auto p = stdx::reserve_vector<Real>(DD.size()+1);
+            for(auto d : DD) p.push_back(sqr(d));
+            //Weight left out by a truncated SVD
+            //is discarded along with the smallest
+            if(tail > 0) p.push_back(tail);
+            probs = Vector(move(p),VecRange{DD.size()+(tail > 0)});
             }
 
         Real truncerr = 0;
@@ -120,7 +206,7 @@ svdImpl(ITensor const& A,
             {
             tie(truncerr,docut_lower,docut_upper,ndegen) = truncate(probs,maxdim,mindim,cutoff,
                                                                     absoluteCutoff,doRelCutoff,args);
-            m = probs.size();
+            m = std::min<long>(probs.size(),DD.size());
             resize(DD,m);
             reduceCols(UU,m);
             reduceCols(VV,m);
@@ -177,40 +263,85 @@ svdImpl(ITensor const& A,
         auto Nblock = blocks.size();
         if(Nblock == 0) throw ResultIsZero("IQTensor has no blocks");
 
-        //TODO: optimize allocation/lookup of Umats,Vmats
-        //      etc. by allocating memory ahead of time (see algs.cc)
-        //      and making Umats a vector of MatrixRef's to this memory
-        auto Umats = vector<Mat<T>>(Nblock);
-        auto Vmats = vector<Mat<T>>(Nblock);
+        if(dim(uI) == 0) throw ResultIsZero("dim(uI) == 0");
+        if(dim(vI) == 0) throw ResultIsZero("dim(vI) == 0");
+
+        auto tsvd = TruncSVD(args,do_truncate,maxdim,mindim,cutoff,absoluteCutoff,doRelCutoff);
+        auto order = blockOrder(blocks);
+        auto nthread = Args::global().getInt("NThread",1);
 
-        //TODO: allocate dvecs in a single allocation
-        //      make dvecs a vector<VecRef>
-        auto dvecs = vector<Vector>(Nblock);
+        auto UVdata = vector<T>{};
+        auto Umats = vector<MatRef<T>>(Nblock);
+        auto Vmats = vector<MatRef<T>>(Nblock);
 
-        auto alleig = stdx::reserve_vector<Real>(std::min(dim(uI),dim(vI)));
+        auto ddata = vector<Real>{};
+        auto dvecs = vector<VectorRef>(Nblock);
+
+        auto tails = vector<Real>(Nblock);
+        size_t totaldsize = 0;
+        Real tail = 0;
+        while(true)
+            {
+            //U, V and the singular values of all
+            //blocks share one allocation each
+            totaldsize = 0;
+            size_t totalUVsize = 0;
+            for(auto b : range(Nblock))
+                {
+                auto rM = nrows(blocks[b].M),
+                     cM = ncols(blocks[b].M);
+                auto nsv = tsvd.nsv(rM,cM);
+                totaldsize += nsv;
+                totalUVsize += (rM+cM)*nsv;
+                }
+            UVdata.assign(totalUVsize,0);
+            ddata.assign(totaldsize,0);
+
+            totaldsize = 0;
+            totalUVsize = 0;
+            for(auto b : range(Nblock))
+                {
+                auto rM = nrows(blocks[b].M),
+                     cM = ncols(blocks[b].M);
+                auto nsv = tsvd.nsv(rM,cM);
+                Umats[b] = makeMatRef(UVdata.data()+totalUVsize,rM*nsv,rM,nsv);
+                totalUVsize += rM*nsv;
+                Vmats[b] = makeMatRef(UVdata.data()+totalUVsize,cM*nsv,cM,nsv);
+                totalUVsize += cM*nsv;
+                dvecs[b] = makeVecRef(ddata.data()+totaldsize,nsv);
+                totaldsize += nsv;
+                }
+
+            //Factorize the blocks concurrently, largest
+            //first so a big block is not left until the end
+            auto factorBlock = [&](long n)
+                {
+                auto b = order[n];
+                tails[b] = randomSVDRef(makeRef(blocks[b].M),Umats[b],dvecs[b],Vmats[b],
+                                        tsvd.npower,thresh,method);
+                //conjugate VV so later we can just do
+                //U*D*V to reconstruct ITensor A:
+                conjugate(Vmats[b]);
+                };
+            if(nthread > 1) threadPool(nthread).run(Nblock,factorBlock,nthread);
+            else            for(auto n : range(Nblock)) factorBlock(n);
+
+            tail = 0;
+            for(auto t : tails) tail += t;
+            if(tsvd.accept(tail,sqr(norm(makeVecRef(ddata.data(),ddata.size())))+tail)) break;
+            }
+
+        auto alleig = stdx::reserve_vector<Real>(totaldsize+1);
 
         auto alleigqn = vector<EigQN>{};
         if(compute_qn)
             {
-            alleigqn = stdx::reserve_vector<EigQN>(std::min(dim(uI),dim(vI)));
+            alleigqn = stdx::reserve_vector<EigQN>(totaldsize);
             }
 
-        if(dim(uI) == 0) throw ResultIsZero("dim(uI) == 0");
-        if(dim(vI) == 0) throw ResultIsZero("dim(vI) == 0");
-
         for(auto b : range(Nblock))
             {
-            auto& M = blocks[b].M;
-            auto& UU = Umats.at(b);
-            auto& VV = Vmats.at(b);
-            auto& d =  dvecs.at(b);
-
-            SVD(M,UU,d,VV,thresh);
-
-            //conjugate VV so later we can just do
-            //U*D*V to reconstruct ITensor A:
-            conjugate(VV);
-
+            auto& d = dvecs[b];
             alleig.insert(alleig.end(),d.begin(),d.end());
             if(compute_qn)
                 {
@@ -232,6 +363,10 @@ svdImpl(ITensor const& A,
         stdx::sort(alleig,std::greater<Real>{});
         if(compute_qn) stdx::sort(alleigqn,std::greater<EigQN>{});
 
+        //Weight left out by a truncated SVD
+        //is discarded along with the smallest
+        if(tail > 0) alleig.push_back(tail);
+
         auto probs = Vector(move(alleig),VecRange{alleig.size()});
 
         long m = probs.size();
@@ -243,7 +378,7 @@ svdImpl(ITensor const& A,
             {
             tie(truncerr,docut_lower,docut_upper,ndegen) = truncate(probs,maxdim,mindim,cutoff,
                                                                     absoluteCutoff,doRelCutoff,args);
-            m = probs.size();
+            m = std::min<long>(probs.size(),totaldsize);
             alleigqn.resize(m);
             }
 
@@ -309,8 +444,7 @@ svdImpl(ITensor const& A,
                 continue; 
                 }
 
-            resize(d,this_m);
-            qn(uI,1+B.i1);
+            d = subVector(d,0,this_m);
             Liq.emplace_back(qn(uI,1+B.i1),this_m);
             Riq.emplace_back(qn(vI,1+B.i2),this_m);
             }
@@ -352,8 +486,7 @@ svdImpl(ITensor const& A,
             assert(pU.data() != nullptr);
             assert(uI.blocksize0(B.i1) == long(nrows(UU)));
             auto Uref = makeMatRef(pU,uI.blocksize0(B.i1),L.blocksize0(n));
-            reduceCols(UU,L.blocksize0(n));
-            Uref &= UU;
+            Uref &= columns(UU,0,L.blocksize0(n));
 
             auto dind = stdx::make_array(n,n);
             auto pD = getBlock(Dstore,Dis,dind);
@@ -366,11 +499,7 @@ svdImpl(ITensor const& A,
             assert(pV.data() != nullptr);
             assert(vI.blocksize0(B.i2) == long(nrows(VV)));
             auto Vref = makeMatRef(pV.data(),pV.size(),vI.blocksize0(B.i2),R.blocksize0(n));
-            reduceCols(VV,R.blocksize0(n));
-            //println("Doing Vref &= VV");
-            //Print(Vref.range());
-            //Print(VV.range());
-            Vref &= VV;
+            Vref &= columns(VV,0,R.blocksize0(n));
 
             /////////DEBUG
             //Matrix D(d.size(),d.size());
@@ -14,12 +14,14 @@
 // limitations under the License.
 //
 #include <limits>
+#include <random>
 #include <stdexcept>
 #include <tuple>
 #include "itensor/tensor/lapack_wrap.h"
 #include "itensor/tensor/algs.h"
 #include "itensor/util/iterate.h"
 #include "itensor/global.h"
+#include "itensor/util/counters.h"
 
 using std::move;
 using std::sqrt;
@@ -33,6 +35,9 @@ namespace detail {
     int
     hermitianDiag(int N, Real *Udata, Real *ddata)
         {
+        //dsyev takes about 9N^3 flops
+        //(4N^3/3 to make M tridiagonal)
+        countFlops(9.*N*N*N);
         LAPACK_INT info = 0;
         dsyev_wrapper('V','U',N,Udata,ddata,info);
         return info;
@@ -40,6 +45,7 @@ namespace detail {
     int
     hermitianDiag(int N, Cplx *Udata,Real *ddata)
         {
+        countFlops(4*9.*N*N*N);
         return zheev_wrapper(N,Udata,ddata);
         }
 } //namespace detail
@@ -598,6 +604,153 @@ SVDRef(MatRefc<T> const& M,
 template void SVDRef(MatRefc<Real> const&,MatRef<Real> const&, VectorRef const&, MatRef<Real> const&,Real);
 template void SVDRef(MatRefc<Cplx> const&,MatRef<Cplx> const&, VectorRef const&, MatRef<Cplx> const&,Real);
 
+LAPACK_INT static
+lapackSVD(SVDMethod method, LAPACK_INT m, LAPACK_INT n,
+          Real* A, Real* s, Real* u, Real* vt)
+    {
+    if(method == SVDGesdd) return gesdd_wrapper(m,n,A,s,u,vt);
+    return gesvd_wrapper(m,n,A,s,u,vt);
+    }
+
+LAPACK_INT static
+lapackSVD(SVDMethod method, LAPACK_INT m, LAPACK_INT n,
+          Cplx* A, Real* s, Cplx* u, Cplx* vt)
+    {
+    if(method == SVDGesdd) return gesdd_wrapper(m,n,A,s,u,vt);
+    return gesvd_wrapper(m,n,A,s,u,vt);
+    }
+
+//SVD by a LAPACK driver,
+//returns false if it failed
+template<typename T>
+bool
+SVDLapack(MatRefc<T> const& M,
+          MatRef<T>  const& U,
+          VectorRef  const& D,
+          MatRef<T>  const& V,
+          SVDMethod method)
+    {
+    LAPACK_INT m = nrows(M),
+               n = ncols(M);
+    auto k = std::min(m,n);
+    if(k == 0) return true;
+
+    //LAPACK overwrites its input and
+    //needs contiguous column-major storage
+    auto A = Mat<T>(M);
+    auto u = Mat<T>(m,k);
+    auto vt = Mat<T>(k,n);
+    auto s = Vector(k);
+
+    //Rough count for computing U and V (Golub and Van Loan)
+    countFlops((isCplx(M) ? 4. : 1.)*(6.*m*n*k+20.*k*k*k));
+    auto info = lapackSVD(method,m,n,A.data(),s.data(),u.data(),vt.data());
+    if(info != 0) return false;
+
+    U &= u;
+    D &= s;
+    V &= transpose(vt);
+    if(isCplx(M)) conjugate(V);
+    return true;
+    }
+
+template<typename T>
+void
+SVDRef(MatRefc<T> const& M,
+       MatRef<T>  const& U,
+       VectorRef  const& D,
+       MatRef<T>  const& V,
+       SVDMethod method,
+       Real thresh)
+    {
+    if(method == SVDRecursive)
+        {
+        SVDRefImpl(M,U,D,V,thresh);
+        return;
+        }
+    if(SVDLapack(M,U,D,V,method)) return;
+    //Failed to converge: try the
+    //other driver, then the recursive SVD
+    if(method == SVDGesdd && SVDLapack(M,U,D,V,SVDGesvd)) return;
+    SVDRefImpl(M,U,D,V,thresh);
+    }
+template void SVDRef(MatRefc<Real> const&,MatRef<Real> const&, VectorRef const&, MatRef<Real> const&,SVDMethod,Real);
+template void SVDRef(MatRefc<Cplx> const&,MatRef<Cplx> const&, VectorRef const&, MatRef<Cplx> const&,SVDMethod,Real);
+
+void static
+gaussianFill(MatrixRef const& M, std::mt19937 & rng)
+    {
+    auto dist = std::normal_distribution<Real>{};
+    for(auto& el : M) el = dist(rng);
+    }
+
+void static
+gaussianFill(CMatrixRef const& M, std::mt19937 & rng)
+    {
+    auto dist = std::normal_distribution<Real>{};
+    for(auto& el : M) el = Cplx(dist(rng),dist(rng));
+    }
+
+template<typename T>
+Real
+randomSVDRef(MatRefc<T> const& M,
+             MatRef<T>  const& U,
+             VectorRef  const& D,
+             MatRef<T>  const& V,
+             long npower,
+             Real thresh,
+             SVDMethod method)
+    {
+    auto Mr = nrows(M),
+         Mc = ncols(M);
+    auto nsv = ncols(U);
+    if(nsv >= std::min(Mr,Mc))
+        {
+        SVDRef(M,U,D,V,method,thresh);
+        return 0.;
+        }
+
+    //Mh = conj(transpose(M))
+    Mat<T> Mconj;
+    auto Mh = transpose(M);
+    if(isCplx(M))
+        {
+        Mconj = conj(M);
+        Mh = transpose(makeRefc(Mconj));
+        }
+
+    //Find an orthonormal basis Q for the range of M
+    //from a random block of vectors. The generator is
+    //local (and seeded by the shape of M) so results
+    //are reproducible and blocks can run concurrently.
+    auto rng = std::mt19937(Mr*7919+Mc);
+    auto Q = Mat<T>(Mr,nsv);
+    auto Z = Mat<T>(Mc,nsv);
+    gaussianFill(makeRef(Z),rng);
+    mult(M,Z,Q);
+    orthog(Q,2);
+    for(long p = 0; p < npower; ++p)
+        {
+        mult(Mh,Q,Z);
+        orthog(Z,2);
+        mult(M,Z,Q);
+        orthog(Q,2);
+        }
+
+    //conj(transpose(M))*Q = V*DD*conj(transpose(W))
+    //so M is approximately (Q*W)*DD*conj(transpose(V))
+    mult(Mh,Q,Z);
+    auto W = Mat<T>(nsv,nsv);
+    SVDRef(makeRefc(Z),V,D,makeRef(W),method,thresh);
+    mult(Q,W,U);
+
+    auto tail = sqr(norm(M));
+    for(auto d : D) tail -= sqr(d);
+    return std::max(tail,0.);
+    }
+template Real randomSVDRef(MatRefc<Real> const&,MatRef<Real> const&,VectorRef const&,MatRef<Real> const&,long,Real,SVDMethod);
+template Real randomSVDRef(MatRefc<Cplx> const&,MatRef<Cplx> const&,VectorRef const&,MatRef<Cplx> const&,long,Real,SVDMethod);
+
 
 
 //void
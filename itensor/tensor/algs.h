@@ -22,6 +22,13 @@ namespace itensor {
 
 static const Real SVD_THRESH = 1E-5;
 
+//Ways SVD can compute the factorization:
+// o SVDRecursive - diagonalize M*M^dagger, then recursively
+//   refine the small singular values (see SVD below)
+// o SVDGesdd - LAPACK divide-and-conquer driver ?gesdd
+// o SVDGesvd - LAPACK QR iteration driver ?gesvd
+enum SVDMethod { SVDRecursive, SVDGesdd, SVDGesvd };
+
 //
 // diagHermitian diagonalizes a
 // Hermitian (and/or real symmetric) matrix M 
@@ -116,6 +123,59 @@ SVD(MatM && M,
     MatV && V,
     Real thresh = SVD_THRESH);
 
+//Same as above, computing the SVD by the given method
+//(thresh is only used by SVDRecursive, and if a LAPACK
+//driver fails to converge it falls back to SVDRecursive)
+template<class MatM, class MatU,class VecD,class MatV,
+         class = stdx::require<
+         hasMatRange<MatM>,
+         hasMatRange<MatU>,
+         hasVecRange<VecD>,
+         hasMatRange<MatV>
+         >>
+void
+SVD(MatM && M,
+    MatU && U,
+    VecD && D,
+    MatV && V,
+    SVDMethod method,
+    Real thresh = SVD_THRESH);
+
+//
+// Truncated SVD by randomized range finding
+//
+// Computes only the nsv largest singular values D
+// of M and the corresponding columns of U and V,
+// so M is approximately U*DD*conj(transpose(V)).
+// A random block of nsv vectors is multiplied by M
+// and conj(transpose(M)) npower times to find the
+// range of M, and the exact SVD of M projected
+// onto this range is computed.
+//
+// Returns the weight of M left out, which is
+// norm(M)^2 minus the sum of the squares of D.
+//
+// If nsv >= min(nrows(M),ncols(M)) the full SVD
+// is computed and the return value is zero. The
+// full (or projected) SVD is computed by method.
+//
+template<class MatM, class MatU,class VecD,class MatV,
+         class = stdx::require<
+         hasMatRange<MatM>,
+         hasMatRange<MatU>,
+         hasVecRange<VecD>,
+         hasMatRange<MatV>
+         >>
+Real
+randomSVD(MatM && M,
+          MatU && U,
+          VecD && D,
+          MatV && V,
+          long nsv,
+          long npower = 2,
+          Real thresh = SVD_THRESH,
+          SVDMethod method = SVDRecursive);
+
 
 } //namespace itensor
 
@@ -189,6 +189,71 @@ SVD(MatM && M,
     SVDRef(makeRef(M),makeRef(U),makeRef(D),makeRef(V),thresh);
     }
 
+template<typename T>
+void
+SVDRef(MatRefc<T> const& M,
+       MatRef<T>  const& U,
+       VectorRef  const& D,
+       MatRef<T>  const& V,
+       SVDMethod method,
+       Real thresh);
+
+template<class MatM,
+         class MatU,
+         class VecD,
+         class MatV,
+         class>
+void
+SVD(MatM && M,
+    MatU && U,
+    VecD && D,
+    MatV && V,
+    SVDMethod method,
+    Real thresh)
+    {
+    auto Mr = nrows(M),
+         Mc = ncols(M);
+    auto nsv = std::min(Mr,Mc);
+    resize(U,Mr,nsv);
+    resize(V,Mc,nsv);
+    resize(D,nsv);
+    SVDRef(makeRef(M),makeRef(U),makeRef(D),makeRef(V),method,thresh);
+    }
+
+template<typename T>
+Real
+randomSVDRef(MatRefc<T> const& M,
+             MatRef<T>  const& U,
+             VectorRef  const& D,
+             MatRef<T>  const& V,
+             long npower,
+             Real thresh,
+             SVDMethod method);
+
+template<class MatM,
+         class MatU,
+         class VecD,
+         class MatV,
+         class>
+Real
+randomSVD(MatM && M,
+          MatU && U,
+          VecD && D,
+          MatV && V,
+          long nsv,
+          long npower,
+          Real thresh,
+          SVDMethod method)
+    {
+    auto Mr = nrows(M),
+         Mc = ncols(M);
+    nsv = std::min<long>(nsv,std::min(Mr,Mc));
+    resize(U,Mr,nsv);
+    resize(V,Mc,nsv);
+    resize(D,nsv);
+    return randomSVDRef(makeRef(M),makeRef(U),makeRef(D),makeRef(V),npower,thresh,method);
+    }
+
 } //namespace itensor
 
 #endif
@@ -15,10 +15,13 @@
 //
 //TODO: replace unordered_map with a simpler container (small_map? or jump directly to location?)
 #include <unordered_map>
-#include <future>
+#include <atomic>
+#include <list>
 
 #include "itensor/util/multalloc.h"
 #include "itensor/util/cputime.h"
+#include "itensor/util/scratch.h"
+#include "itensor/util/threadpool.h"
 #include "itensor/detail/algs.h"
 #include "itensor/detail/gcounter.h"
 #include "itensor/tensor/mat.h"
@@ -679,56 +682,239 @@ class CABqueue
     void 
     run(int numthread)
         {
-
-        //////////
-        ////Analyze tasks:
-        //println("number of distinct offCs is ",subtask.size());
-        //int ttasks = 0;
-        //for(auto& st : subtask) ttasks += st.second.size();
-        //println("number of distinct tasks is ",ttasks);
-        //size_t maxj = 0;
-        //for(const auto& st : subtask)
-        //    maxj = std::max(st.second.size(),maxj);
-        //println("max subtask size is ",maxj);
-        //////////
-
-        //Loop over threads in a round-robin fashion.
-        //Assign all tasks with the same memory 
-        //destination (offC) to the same thread. 
-        vector<vector<ABoffC>> threadtask(numthread);
-        int ss = 0;
+        //All tasks with the same memory destination (offC)
+        //form one group, run by a single thread.
+        //Groups are handed out largest (by number of
+        //multiply-adds) first to the shared thread pool,
+        //each thread taking the next group as soon as it
+        //finishes its last, which keeps the threads evenly loaded
+        struct Group
+            {
+            Real flops = 0.;
+            vector<ABoffC> const* tasks = nullptr;
+            };
+        auto groups = vector<Group>{};
+        groups.reserve(subtask.size());
         for(auto& t : subtask)
             {
-            auto& st_tasks = t.second;
-            auto& tt = threadtask[ss];
-            std::move(st_tasks.begin(),st_tasks.end(),std::inserter(tt,tt.end()));
-            ss = (ss+1)%numthread;
+            auto g = Group{};
+            g.tasks = &t.second;
+            for(auto& task : t.second)
+                {
+                g.flops += Real(nrows(task.mA))*ncols(task.mA)*ncols(task.mB);
+                }
+            groups.push_back(g);
             }
+        std::sort(groups.begin(),groups.end(),
+                  [](Group const& g1, Group const& g2) { return g1.flops > g2.flops; });
 
-        //"Package" thread tasks into std::future objects
-        //which begin running once they are created
-        vector<std::future<void>> futs(numthread);
-        assert(threadtask.size()==futs.size());
-        for(size_t i = 0; i < futs.size(); ++i)
+        threadPool(numthread).run(groups.size(),[&groups](long n)
             {
-            auto& tt = threadtask[i];
-            //printfln("task size for thread %d is %d",i,tt.size());
-            futs[i] = std::async(std::launch::async,
-                      [&tt]()
-                          { 
-                          for(const auto& task : tt)
-                            task.execute();
-                          }
-                      );
-            }
-        //Wait for futures to complete
-        for(auto& ft : futs) 
+            for(auto& task : *(groups[n].tasks)) task.execute();
+            },numthread);
+        }
+    };
+
+
+//
+// CPropsCache - the CProps of the most recently
+// used label patterns and extents, most recent first
+//
+// Only the labels and the extents of A and B
+// enter the analysis done by CProps::compute
+// (the extents of C follow from those of A and B)
+// so these make up the key.
+//
+class CPropsCache
+    {
+    public:
+    using key_type = InfArray<long,64ul>;
+    private:
+    struct Item
+        {
+        size_t hash = 0;
+        key_type key;
+        CProps props;
+
+        Item(size_t h,
+             key_type const& k,
+             Labels const& ai,
+             Labels const& bi,
+             Labels const& ci)
+          : hash(h), key(k), props(ai,bi,ci)
+            { }
+        };
+    std::list<Item> items_;
+    public:
+
+    //Returns nullptr if no CProps stored for key
+    CProps const*
+    find(size_t hash, key_type const& key);
+
+    //Returns a new, not yet computed CProps for key
+    CProps&
+    insert(size_t hash, 
+           key_type const& key,
+           Labels const& ai,
+           Labels const& bi,
+           Labels const& ci);
+
+    void
+    clear() { items_.clear(); }
+    };
+
+std::atomic<size_t> static cprops_maxsize_{100};
+
+std::atomic<long> static cprops_hits_{0},
+                         cprops_misses_{0};
+
+CPropsCache static&
+cpropsCache()
+    {
+    static thread_local CPropsCache cache;
+    return cache;
+    }
+
+bool static
+sameKey(CPropsCache::key_type const& k1, CPropsCache::key_type const& k2)
+    {
+    return k1.size() == k2.size() && std::equal(k1.begin(),k1.end(),k2.begin());
+    }
+
+CProps const* CPropsCache::
+find(size_t hash, key_type const& key)
+    {
+    for(auto it = items_.begin(); it != items_.end(); ++it)
+        {
+        if(it->hash == hash && sameKey(it->key,key))
             {
-            ft.wait();
+            //Move to front, marking as most recently used
+            items_.splice(items_.begin(),items_,it);
+            ++cprops_hits_;
+            return &(items_.front().props);
             }
         }
-    };
+    ++cprops_misses_;
+    return nullptr;
+    }
+
+CProps& CPropsCache::
+insert(size_t hash, 
+       key_type const& key,
+       Labels const& ai,
+       Labels const& bi,
+       Labels const& ci)
+    {
+    items_.emplace_front(hash,key,ai,bi,ci);
+    auto maxsize = std::max(cprops_maxsize_.load(),size_t(1));
+    while(items_.size() > maxsize) items_.pop_back();
+    return items_.front().props;
+    }
+
+template<typename RangeT, typename VA, typename VB>
+size_t
+cpropsKey(CPropsCache::key_type & key,
+          Labels const& ai, 
+          Labels const& bi, 
+          Labels const& ci,
+          TenRefc<RangeT,VA> const& A,
+          TenRefc<RangeT,VB> const& B)
+    {
+    key.clear();
+    auto add = [&key](long k) { key.push_back(k); };
+    add(ai.size());
+    for(auto l : ai) add(l);
+    add(bi.size());
+    for(auto l : bi) add(l);
+    add(ci.size());
+    for(auto l : ci) add(l);
+    for(auto i : range(ai.size())) add(A.extent(i));
+    for(auto i : range(bi.size())) add(B.extent(i));
+    size_t h = key.size();
+    for(auto k : key) h ^= std::hash<long>()(k) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+    }
+
+ContractCacheStats
+contractCacheStats()
+    {
+    auto s = ContractCacheStats{};
+    s.hits = cprops_hits_.load();
+    s.misses = cprops_misses_.load();
+    return s;
+    }
 
+void
+resetContractCacheStats()
+    {
+    cprops_hits_ = 0;
+    cprops_misses_ = 0;
+    }
+
+size_t
+contractCacheSize() { return cprops_maxsize_.load(); }
+
+void
+setContractCacheSize(size_t maxsize) 
+    { 
+    cprops_maxsize_ = maxsize; 
+    if(maxsize == 0) clearContractCache();
+    }
+
+void
+clearContractCache() { cpropsCache().clear(); }
+
+
+//Number of multiply-adds above which
+//contract splits its gemm over threads
+Real constexpr
+threadedGemmSize() { return Real(1ul << 21); }
+
+//Computes gemm(A,B,C,alpha,beta), splitting the columns
+//of C into blocks handled by separate threads when
+//"NThread" in Args::global() is more than one
+//(each thread owns its own block of C).
+//gemm assumes each block is contiguous, so a transposed
+//B is first copied to column-major order (an O(n*k) cost
+//next to the O(m*n*k) product)
+template<typename VA, typename VB>
+void
+threadedGemm(MatRefc<VA> A,
+             MatRefc<VB> B,
+             MatRef<common_type<VA,VB>> C,
+             Real alpha,
+             Real beta)
+    {
+    auto nthread = Args::global().getInt("NThread",1);
+    if(nthread <= 1 || Real(nrows(A))*ncols(A)*ncols(B) < threadedGemmSize())
+        {
+        gemm(A,B,C,alpha,beta);
+        return;
+        }
+    if(isTransposed(C))
+        {
+        //Compute Ct = Bt*At instead,
+        //whose columns are contiguous
+        threadedGemm(transpose(B),transpose(A),transpose(C),alpha,beta);
+        return;
+        }
+    if(isTransposed(B))
+        {
+        //A column block of a transposed B is strided,
+        //so make a column-major copy of B to split
+        auto Bn = Mat<VB>(B);
+        threadedGemm(A,makeRefc(Bn),C,alpha,beta);
+        return;
+        }
+    auto nc = long(ncols(C));
+    auto nblock = std::min(long(nthread),nc);
+    threadPool(nthread).run(nblock,[&A,&B,&C,alpha,beta,nc,nblock](long b)
+        {
+        auto c0 = (b*nc)/nblock,
+             c1 = ((b+1)*nc)/nblock;
+        gemm(A,columns(B,c0,c1),columns(C,c0,c1),alpha,beta);
+        },nthread);
+    }
 
 template<typename range_t, typename VA, typename VB>
 void 
@@ -747,7 +933,9 @@ contract(CProps const& p,
     auto Bbufsize = isCplx(B) ? 2ul*Bpsize : Bpsize;
     auto Cbufsize = isCplx(C) ? 2ul*Cpsize : Cpsize;
 
-    auto d = std::vector<Real>(Abufsize+Bbufsize+Cbufsize);
+    //Permuted copies go in the thread's scratch arena,
+    //so repeated contractions need not allocate
+    auto d = ScratchBuffer(Abufsize+Bbufsize+Cbufsize);
     auto ab = MAKE_SAFE_PTR(d.data(),d.size());
     auto bb = ab+Abufsize;
     auto cb = bb+Bbufsize;
@@ -755,7 +943,8 @@ contract(CProps const& p,
     MatRefc<VA> aref;
     if(p.permuteA())
         {
-        SCOPED_TIMER(12)
+        PROFILE_SCOPE("permute")
+        profileCount(0,2.*Apsize*sizeof(VA));
         auto aptr = SAFE_REINTERPRET(VA,ab);
         auto tref = makeTenRef(SAFE_PTR_GET(aptr,Apsize),Apsize,&p.newArange);
         tref &= permute(A,p.PA);
@@ -776,7 +965,8 @@ contract(CProps const& p,
     MatRefc<VB> bref;
     if(p.permuteB())
         {
-        SCOPED_TIMER(13)
+        PROFILE_SCOPE("permute")
+        profileCount(0,2.*Bpsize*sizeof(VB));
         auto bptr = SAFE_REINTERPRET(VB,bb);
         auto tref = makeTenRef(SAFE_PTR_GET(bptr,Bpsize),Bpsize,&p.newBrange);
         tref &= permute(B,p.PB);
@@ -798,6 +988,8 @@ contract(CProps const& p,
     TenRef<Range,VC> newC;
     if(p.permuteC())
         {
+        //gemm only reads newC if beta != 0
+        if(beta != 0.) std::fill(d.data()+Abufsize+Bbufsize,d.data()+d.size(),0.);
         auto cptr = SAFE_REINTERPRET(VC,cb);
         newC = makeTenRef(SAFE_PTR_GET(cptr,Cpsize),Cpsize,&p.newCrange);
         cref = makeMatRef(newC.store(),nrows(aref),ncols(bref));
@@ -814,13 +1006,12 @@ contract(CProps const& p,
             }
         }
 
-    START_TIMER(11)
-    gemm(aref,bref,cref,alpha,beta);
-    STOP_TIMER(11)
+    threadedGemm(aref,bref,cref,alpha,beta);
 
     if(p.permuteC())
         {
-        SCOPED_TIMER(14)
+        PROFILE_SCOPE("permute")
+        profileCount(0,2.*Cpsize*sizeof(VC));
 #ifdef DEBUG
         if(isTrivial(p.PC)) Error("Calling permute in contract with a trivial permutation");
 #endif
@@ -864,11 +1055,68 @@ contract(TenRefc<RangeT,VA> A, Labels const& ai,
         }
     else
         {
-        CProps props(ai,bi,ci);
-        props.compute(A,B,C);
-        contract(props,A,B,C,alpha,beta);
+        if(contractCacheSize() == 0)
+            {
+            CProps props(ai,bi,ci);
+            props.compute(A,B,C);
+            contract(props,A,B,C,alpha,beta);
+            return;
+            }
+        auto& cache = cpropsCache();
+        auto key = CPropsCache::key_type{};
+        auto hash = cpropsKey(key,ai,bi,ci,A,B);
+        auto* pprops = cache.find(hash,key);
+        if(!pprops)
+            {
+            auto& props = cache.insert(hash,key,ai,bi,ci);
+            props.compute(A,B,C);
+            pprops = &props;
+            }
+        contract(*pprops,A,B,C,alpha,beta);
+        }
+    }
+
+template<typename RangeT>
+bool
+contractAsGemm(RangeT const& Arange, Labels const& ai,
+               RangeT const& Brange, Labels const& bi,
+               RangeT const& Crange, Labels const& ci,
+               GemmShape & shape,
+               bool & swapAB)
+    {
+    if(ai.empty() || bi.empty()) return false;
+    //CProps only looks at the ranges
+    auto A = TenRefc<RangeT,Real>(Datac{},&Arange);
+    auto B = TenRefc<RangeT,Real>(Datac{},&Brange);
+    auto C = TenRefc<RangeT,Real>(Datac{},&Crange);
+    CProps p(ai,bi,ci);
+    p.compute(A,B,C);
+    if(p.permuteA() || p.permuteB() || p.permuteC()) return false;
+    shape.k = p.dmid;
+    if(p.Ctrans())
+        {
+        //C is stored as Ct = Bt*At
+        shape.m = p.dright;
+        shape.n = p.dleft;
+        shape.transA = !p.Btrans();
+        shape.transB = !p.Atrans();
+        swapAB = true;
+        }
+    else
+        {
+        shape.m = p.dleft;
+        shape.n = p.dright;
+        shape.transA = p.Atrans();
+        shape.transB = p.Btrans();
+        swapAB = false;
         }
+    return true;
     }
+template bool
+contractAsGemm(Range const&, Labels const&,
+               Range const&, Labels const&,
+               Range const&, Labels const&,
+               GemmShape &, bool &);
 
 //Explicit template instantiations:
 template void 
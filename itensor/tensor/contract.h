@@ -17,6 +17,7 @@
 #define __ITENSOR_CONTRACT_H
 
 #include "itensor/tensor/vec.h"
+#include "itensor/tensor/gemmbatch.h"
 #include "itensor/util/args.h"
 #include "itensor/util/iterate.h"
 #include "itensor/detail/gcounter.h"
@@ -40,6 +41,54 @@ contract(Ten<R,VA> const& A, Labels const& ai,
          Real alpha = 1.,
          Real beta = 0.);
 
+//
+// contract remembers the permutations and matrix
+// shapes it works out for the most recently seen
+// label patterns and extents, so repeated contractions
+// go straight to permuting and calling gemm.
+// Each thread has its own cache; the counts below
+// are totals over all threads.
+//
+struct ContractCacheStats
+    {
+    long hits = 0,
+         misses = 0;
+    };
+
+ContractCacheStats
+contractCacheStats();
+
+void
+resetContractCacheStats();
+
+//Number of patterns kept per thread (default 100);
+//setting zero turns caching off
+size_t
+contractCacheSize();
+
+void
+setContractCacheSize(size_t maxsize);
+
+//Clear the calling thread's cache
+void
+clearContractCache();
+
+//
+// If contract(A,ai,B,bi,C,ci) for tensors with the
+// ranges Arange, Brange, Crange can be done as one
+// matrix product without permuting A, B or C, 
+// set shape so that gemmBatch(shape,...) with factors
+// A and B (B and A if swapAB is set to true) computes C,
+// and return true
+//
+template<typename RangeT>
+bool
+contractAsGemm(RangeT const& Arange, Labels const& ai,
+               RangeT const& Brange, Labels const& bi,
+               RangeT const& Crange, Labels const& ci,
+               GemmShape & shape,
+               bool & swapAB);
+
 template<typename range_type>
 void 
 contractloop(TenRefc<range_type> A, Labels const& ai, 
@@ -16,6 +16,8 @@
 #include "itensor/tensor/lapack_wrap.h"
 #include "itensor/tensor/slicemat.h"
 #include "itensor/util/safe_ptr.h"
+#include "itensor/util/scratch.h"
+#include "itensor/util/counters.h"
 
 namespace itensor {
 
@@ -98,7 +100,7 @@ gemm_emulator(MatRefc<VA> A,
     auto Brd = SAFE_REINTERPRET(const Real,Bd);
     auto Crd = SAFE_REINTERPRET(Real,Cd);
 
-    auto d = std::vector<Real>(Abufsize+Bbufsize+Cbufsize);
+    auto d = ScratchBuffer(Abufsize+Bbufsize+Cbufsize);
     auto pd = MAKE_SAFE_PTR(d.data(),d.size());
     auto ab = pd;
     auto ae = ab+Abufsize;
@@ -219,6 +221,24 @@ gemm_impl(MatRefc<Cplx> A,
           Real alpha,
           Real beta)
     {
+    if(!isTransposed(A))
+        {
+        //With A stored column-major, its real and imaginary
+        //parts form a 2*nrows(A) x ncols(A) real matrix with
+        //the same layout as C viewed the same way, so a single
+        //dgemm computes both parts of C without any copies
+        gemm_wrapper(false,
+                     isTransposed(B),
+                     2*nrows(A),
+                     ncols(B),
+                     ncols(A),
+                     alpha,
+                     reinterpret_cast<Real const*>(A.data()),
+                     B.data(),
+                     beta,
+                     reinterpret_cast<Real*>(C.data()));
+        return;
+        }
     std::array<const dgemmTask,4> 
     tasks = 
         {{dgemmTask(0,0,0,+alpha,beta),
@@ -274,6 +294,10 @@ gemm(MatRefc<VA> A,
         throw std::runtime_error("mult(_add) AxB -> C: matrix C incompatible");
         }
 #endif
+    PROFILE_SCOPE("gemm")
+    countGemm(gemmFlops<VA,VB>(nrows(A),ncols(B),ncols(A)),
+              (nrows(A)*ncols(A)*sizeof(VA)+nrows(B)*ncols(B)*sizeof(VB)
+               +2.*nrows(C)*ncols(C)*sizeof(common_type<VA,VB>)));
     if(isTransposed(C))
         {
         //Do C = Bt*At instead of Ct=A*B
@@ -0,0 +1,202 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <algorithm>
+#include <tuple>
+#include "itensor/tensor/gemmbatch.h"
+#include "itensor/tensor/lapack_wrap.h"
+#include "itensor/tensor/slicemat.h"
+#include "itensor/util/counters.h"
+
+namespace itensor {
+
+bool
+operator==(GemmShape const& s1, GemmShape const& s2)
+    {
+    return s1.m == s2.m && s1.n == s2.n && s1.k == s2.k
+        && s1.transA == s2.transA && s1.transB == s2.transB;
+    }
+
+bool
+operator<(GemmShape const& s1, GemmShape const& s2)
+    {
+    return std::tie(s1.m,s1.n,s1.k,s1.transA,s1.transB)
+         < std::tie(s2.m,s2.n,s2.k,s2.transA,s2.transB);
+    }
+
+bool
+isSmallGemm(GemmShape const& s)
+    {
+    return s.m <= smallGemmMaxDim()
+        && s.n <= smallGemmMaxDim()
+        && s.k <= smallGemmMaxDim();
+    }
+
+//C = alpha*A*B + beta*C with A an m x k column-major
+//matrix and B(l,j) = b[l*bl+j*bj];
+//if M > 0 then m == M, fixed at compile time
+//so the inner loops can be fully unrolled
+template<long M, typename VA, typename VB, typename VC>
+void
+smallGemm(long m,
+          long n,
+          long k,
+          VA const* a,
+          VB const* b,
+          long bl,
+          long bj,
+          VC * c,
+          Real alpha,
+          Real beta)
+    {
+    long const mm = (M > 0) ? M : m;
+    VC acc[smallGemmMaxDim()];
+    for(long j = 0; j < n; ++j)
+        {
+        for(long i = 0; i < mm; ++i) acc[i] = 0.;
+        for(long l = 0; l < k; ++l)
+            {
+            auto blj = b[l*bl+j*bj];
+            auto* al = a+l*mm;
+            for(long i = 0; i < mm; ++i) acc[i] += al[i]*blj;
+            }
+        auto* cj = c+j*mm;
+        if(beta == 0.)
+            {
+            for(long i = 0; i < mm; ++i) cj[i] = alpha*acc[i];
+            }
+        else
+            {
+            for(long i = 0; i < mm; ++i) cj[i] = alpha*acc[i]+beta*cj[i];
+            }
+        }
+    }
+
+template<typename VA, typename VB, typename VC>
+void
+smallGemm(GemmShape const& s,
+          VA const* a,
+          VB const* b,
+          VC * c,
+          Real alpha,
+          Real beta)
+    {
+    auto m = s.m,
+         n = s.n,
+         k = s.k;
+    VA at[smallGemmMaxDim()*smallGemmMaxDim()];
+    if(s.transA)
+        {
+        //Transpose A so that its columns are contiguous
+        for(long l = 0; l < k; ++l)
+        for(long i = 0; i < m; ++i)
+            {
+            at[i+l*m] = a[l+i*k];
+            }
+        a = at;
+        }
+    auto bl = s.transB ? n : 1l,
+         bj = s.transB ? 1l : k;
+    switch(m)
+        {
+        case 1: smallGemm<1>(m,n,k,a,b,bl,bj,c,alpha,beta); break;
+        case 2: smallGemm<2>(m,n,k,a,b,bl,bj,c,alpha,beta); break;
+        case 3: smallGemm<3>(m,n,k,a,b,bl,bj,c,alpha,beta); break;
+        case 4: smallGemm<4>(m,n,k,a,b,bl,bj,c,alpha,beta); break;
+        case 5: smallGemm<5>(m,n,k,a,b,bl,bj,c,alpha,beta); break;
+        case 6: smallGemm<6>(m,n,k,a,b,bl,bj,c,alpha,beta); break;
+        case 7: smallGemm<7>(m,n,k,a,b,bl,bj,c,alpha,beta); break;
+        case 8: smallGemm<8>(m,n,k,a,b,bl,bj,c,alpha,beta); break;
+        default: smallGemm<0>(m,n,k,a,b,bl,bj,c,alpha,beta); break;
+        }
+    }
+
+//Returns false if the BLAS library has no batched
+//gemm for these element types
+template<typename VA, typename VB, typename VC>
+bool
+gemmBatchBLAS(GemmShape const& s,
+              VA const* const* A,
+              VB const* const* B,
+              VC * const* C,
+              long count,
+              Real alpha,
+              Real beta)
+    {
+    return false;
+    }
+
+#ifdef ITENSOR_USE_GEMM_BATCH
+bool
+gemmBatchBLAS(GemmShape const& s,
+              Real const* const* A,
+              Real const* const* B,
+              Real * const* C,
+              long count,
+              Real alpha,
+              Real beta)
+    {
+    gemm_batch_wrapper(s.transA,s.transB,s.m,s.n,s.k,alpha,A,B,beta,C,count);
+    return true;
+    }
+#endif
+
+template<typename VA, typename VB, typename VC>
+void
+gemmBatch(GemmShape const& s,
+          VA const* const* A,
+          VB const* const* B,
+          VC * const* C,
+          long count,
+          Real alpha,
+          Real beta)
+    {
+    if(count <= 0 || s.m == 0 || s.n == 0) return;
+
+    PROFILE_SCOPE("gemmBatch")
+    if(gemmBatchBLAS(s,A,B,C,count,alpha,beta))
+        {
+        countGemm(count*gemmFlops<VA,VB>(s.m,s.n,s.k),0,count);
+        return;
+        }
+
+    if(isSmallGemm(s))
+        {
+        countGemm(count*gemmFlops<VA,VB>(s.m,s.n,s.k),0,count);
+        for(long i = 0; i < count; ++i)
+            {
+            smallGemm(s,A[i],B[i],C[i],alpha,beta);
+            }
+        return;
+        }
+
+    auto asize = size_t(s.m*s.k),
+         bsize = size_t(s.k*s.n),
+         csize = size_t(s.m*s.n);
+    for(long i = 0; i < count; ++i)
+        {
+        auto aref = s.transA ? transpose(makeMatRefc(A[i],asize,s.k,s.m))
+                             : makeMatRefc(A[i],asize,s.m,s.k);
+        auto bref = s.transB ? transpose(makeMatRefc(B[i],bsize,s.n,s.k))
+                             : makeMatRefc(B[i],bsize,s.k,s.n);
+        gemm(aref,bref,makeMatRef(C[i],csize,s.m,s.n),alpha,beta);
+        }
+    }
+template void gemmBatch(GemmShape const&,Real const* const*,Real const* const*,Real * const*,long,Real,Real);
+template void gemmBatch(GemmShape const&,Cplx const* const*,Real const* const*,Cplx * const*,long,Real,Real);
+template void gemmBatch(GemmShape const&,Real const* const*,Cplx const* const*,Cplx * const*,long,Real,Real);
+template void gemmBatch(GemmShape const&,Cplx const* const*,Cplx const* const*,Cplx * const*,long,Real,Real);
+
+} //namespace itensor
@@ -0,0 +1,77 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_GEMMBATCH_H
+#define __ITENSOR_GEMMBATCH_H
+
+#include "itensor/tensor/types.h"
+
+namespace itensor {
+
+//
+// Shape of the product C = A*B of contiguous,
+// column-major matrices: C is m x n, A is
+// m x k (stored as k x m if transA) and
+// B is k x n (stored as n x k if transB)
+//
+struct GemmShape
+    {
+    long m = 0,
+         n = 0,
+         k = 0;
+    bool transA = false,
+         transB = false;
+    };
+
+bool
+operator==(GemmShape const& s1, GemmShape const& s2);
+
+bool
+operator<(GemmShape const& s1, GemmShape const& s2);
+
+//Products with every dimension at most this
+//size use gemmBatch's built-in kernel
+long constexpr
+smallGemmMaxDim() { return 32l; }
+
+bool
+isSmallGemm(GemmShape const& s);
+
+//
+// Computes C[i] = alpha*A[i]*B[i] + beta*C[i]
+// for i = 0,1,...,count-1, all products having
+// the same shape s. The C[i] must all be different.
+//
+// o If the BLAS library provides a batched gemm
+//   (MKL's cblas_dgemm_batch), Real products are
+//   done in a single call to it.
+// o Otherwise small products (see smallGemmMaxDim)
+//   use a built-in kernel, avoiding the overhead
+//   of a BLAS call per product, and larger ones
+//   call gemm for each product.
+//
+template<typename VA, typename VB, typename VC>
+void
+gemmBatch(GemmShape const& s,
+          VA const* const* A,
+          VB const* const* B,
+          VC * const* C,
+          long count,
+          Real alpha = 1.,
+          Real beta = 0.);
+
+} //namespace itensor
+
+#endif
@@ -13,6 +13,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
+#include <map>
+#include <tuple>
 #include "itensor/tensor/lapack_wrap.h"
 //#include "itensor/tensor/permutecplx.h"
 
@@ -218,11 +220,9 @@ gemm_wrapper(bool transa,
         bt = CblasTrans;
         ldb = n;
         }
-    TIMER_START(31)
     auto palpha = (void*)(&alpha); 
     auto pbeta = (void*)(&beta); 
     cblas_zgemm(CblasColMajor,at,bt,m,n,k,palpha,(void*)A,lda,(void*)B,ldb,pbeta,(void*)C,m);
-    TIMER_STOP(31)
 #else //use Fortran zgemm
     auto *ncA = const_cast<Cplx*>(A);
     auto *ncB = const_cast<Cplx*>(B);
@@ -248,6 +248,35 @@ gemm_wrapper(bool transa,
 #endif
     }
 
+#ifdef ITENSOR_USE_GEMM_BATCH
+//
+// dgemm_batch
+//
+void
+gemm_batch_wrapper(bool transa, 
+                   bool transb,
+                   LAPACK_INT m,
+                   LAPACK_INT n,
+                   LAPACK_INT k,
+                   LAPACK_REAL alpha,
+                   LAPACK_REAL const* const* A,
+                   LAPACK_REAL const* const* B,
+                   LAPACK_REAL beta,
+                   LAPACK_REAL * const* C,
+                   LAPACK_INT count)
+    {
+    LAPACK_INT lda = transa ? k : m,
+               ldb = transb ? n : k;
+    auto at = transa ? CblasTrans : CblasNoTrans,
+         bt = transb ? CblasTrans : CblasNoTrans;
+    //A single group of count products
+    cblas_dgemm_batch(CblasColMajor,&at,&bt,&m,&n,&k,&alpha,
+                      const_cast<LAPACK_REAL const**>(A),&lda,
+                      const_cast<LAPACK_REAL const**>(B),&ldb,&beta,
+                      const_cast<LAPACK_REAL**>(C),&m,1,&count);
+    }
+#endif
+
 void 
 gemv_wrapper(bool trans, 
              LAPACK_REAL alpha,
@@ -391,6 +420,171 @@ zgesdd_wrapper(char *jobz,           //char* specifying how much of U, V to comp
 #endif
     }
 
+//Optimal workspace sizes from LAPACK workspace queries,
+//cached on each thread by driver and matrix shape
+enum SVDDriver { DGESDD, ZGESDD, DGESVD, ZGESVD };
+
+template<typename Query>
+LAPACK_INT
+cachedWorkSize(SVDDriver driver,
+               LAPACK_INT m,
+               LAPACK_INT n,
+               Query && query)
+    {
+    using Key = std::tuple<int,LAPACK_INT,LAPACK_INT>;
+    static thread_local std::map<Key,LAPACK_INT> cache;
+    auto key = Key{driver,m,n};
+    auto it = cache.find(key);
+    if(it != cache.end()) return it->second;
+    //Only a modest number of shapes are
+    //expected, but bound the cache anyway
+    if(cache.size() >= 4096) cache.clear();
+    auto lwork = std::max<LAPACK_INT>(1,query());
+    cache.emplace(key,lwork);
+    return lwork;
+    }
+
+LAPACK_INT
+gesdd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              LAPACK_REAL* A,
+              LAPACK_REAL* s,
+              LAPACK_REAL* u,
+              LAPACK_REAL* vt)
+    {
+    char jobz = 'S';
+    LAPACK_INT k = std::min(m,n);
+    LAPACK_INT lda = std::max<LAPACK_INT>(1,m),
+               ldvt = std::max<LAPACK_INT>(1,k);
+    LAPACK_INT info = 0;
+    std::vector<LAPACK_INT> iwork(8*k);
+    auto call = [&](LAPACK_REAL* work, LAPACK_INT lwork)
+        {
+#ifdef PLATFORM_acml
+        F77NAME(dgesdd)(&jobz,&m,&n,A,&lda,s,u,&lda,vt,&ldvt,work,&lwork,iwork.data(),&info,1);
+#else
+        F77NAME(dgesdd)(&jobz,&m,&n,A,&lda,s,u,&lda,vt,&ldvt,work,&lwork,iwork.data(),&info);
+#endif
+        };
+    auto lwork = cachedWorkSize(DGESDD,m,n,[&call]()
+        {
+        LAPACK_REAL wkopt = 0;
+        call(&wkopt,-1);
+        return LAPACK_INT(wkopt);
+        });
+    std::vector<LAPACK_REAL> work(lwork);
+    call(work.data(),lwork);
+    return info;
+    }
+
+LAPACK_INT
+gesdd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              Cplx* A,
+              LAPACK_REAL* s,
+              Cplx* u,
+              Cplx* vt)
+    {
+    char jobz = 'S';
+    LAPACK_INT k = std::min(m,n),
+               g = std::max(m,n);
+    LAPACK_INT lda = std::max<LAPACK_INT>(1,m),
+               ldvt = std::max<LAPACK_INT>(1,k);
+    LAPACK_INT info = 0;
+    std::vector<LAPACK_REAL> rwork(std::max<LAPACK_INT>(1,std::max(5*k*k+7*k,2*g*k+2*k*k+k)));
+    std::vector<LAPACK_INT> iwork(8*k);
+    auto pA = reinterpret_cast<LAPACK_COMPLEX*>(A);
+    auto pu = reinterpret_cast<LAPACK_COMPLEX*>(u);
+    auto pvt = reinterpret_cast<LAPACK_COMPLEX*>(vt);
+    auto call = [&](Cplx* work, LAPACK_INT lwork)
+        {
+        auto pw = reinterpret_cast<LAPACK_COMPLEX*>(work);
+#ifdef PLATFORM_acml
+        F77NAME(zgesdd)(&jobz,&m,&n,pA,&lda,s,pu,&lda,pvt,&ldvt,pw,&lwork,rwork.data(),iwork.data(),&info,1);
+#else
+        F77NAME(zgesdd)(&jobz,&m,&n,pA,&lda,s,pu,&lda,pvt,&ldvt,pw,&lwork,rwork.data(),iwork.data(),&info);
+#endif
+        };
+    auto lwork = cachedWorkSize(ZGESDD,m,n,[&call]()
+        {
+        Cplx wkopt = 0;
+        call(&wkopt,-1);
+        return LAPACK_INT(wkopt.real());
+        });
+    std::vector<Cplx> work(lwork);
+    call(work.data(),lwork);
+    return info;
+    }
+
+LAPACK_INT
+gesvd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              LAPACK_REAL* A,
+              LAPACK_REAL* s,
+              LAPACK_REAL* u,
+              LAPACK_REAL* vt)
+    {
+    char job = 'S';
+    LAPACK_INT k = std::min(m,n);
+    LAPACK_INT lda = std::max<LAPACK_INT>(1,m),
+               ldvt = std::max<LAPACK_INT>(1,k);
+    LAPACK_INT info = 0;
+    auto call = [&](LAPACK_REAL* work, LAPACK_INT lwork)
+        {
+#ifdef PLATFORM_acml
+        F77NAME(dgesvd)(&job,&job,&m,&n,A,&lda,s,u,&lda,vt,&ldvt,work,&lwork,&info,1,1);
+#else
+        F77NAME(dgesvd)(&job,&job,&m,&n,A,&lda,s,u,&lda,vt,&ldvt,work,&lwork,&info);
+#endif
+        };
+    auto lwork = cachedWorkSize(DGESVD,m,n,[&call]()
+        {
+        LAPACK_REAL wkopt = 0;
+        call(&wkopt,-1);
+        return LAPACK_INT(wkopt);
+        });
+    std::vector<LAPACK_REAL> work(lwork);
+    call(work.data(),lwork);
+    return info;
+    }
+
+LAPACK_INT
+gesvd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              Cplx* A,
+              LAPACK_REAL* s,
+              Cplx* u,
+              Cplx* vt)
+    {
+    char job = 'S';
+    LAPACK_INT k = std::min(m,n);
+    LAPACK_INT lda = std::max<LAPACK_INT>(1,m),
+               ldvt = std::max<LAPACK_INT>(1,k);
+    LAPACK_INT info = 0;
+    std::vector<LAPACK_REAL> rwork(std::max<LAPACK_INT>(1,5*k));
+    auto pA = reinterpret_cast<LAPACK_COMPLEX*>(A);
+    auto pu = reinterpret_cast<LAPACK_COMPLEX*>(u);
+    auto pvt = reinterpret_cast<LAPACK_COMPLEX*>(vt);
+    auto call = [&](Cplx* work, LAPACK_INT lwork)
+        {
+        auto pw = reinterpret_cast<LAPACK_COMPLEX*>(work);
+#ifdef PLATFORM_acml
+        F77NAME(zgesvd)(&job,&job,&m,&n,pA,&lda,s,pu,&lda,pvt,&ldvt,pw,&lwork,rwork.data(),&info,1,1);
+#else
+        F77NAME(zgesvd)(&job,&job,&m,&n,pA,&lda,s,pu,&lda,pvt,&ldvt,pw,&lwork,rwork.data(),&info);
+#endif
+        };
+    auto lwork = cachedWorkSize(ZGESVD,m,n,[&call]()
+        {
+        Cplx wkopt = 0;
+        call(&wkopt,-1);
+        return LAPACK_INT(wkopt.real());
+        });
+    std::vector<Cplx> work(lwork);
+    call(work.data(),lwork);
+    return info;
+    }
+
 //
 // dgeqrf
 //
@@ -19,7 +19,7 @@
 #include <vector>
 #include "itensor/config.h"
 #include "itensor/types.h"
-#include "itensor/util/timers.h"
+#include "itensor/util/profiler.h"
 
 //
 // Headers and typedefs
@@ -33,6 +33,7 @@
 #ifdef PLATFORM_lapack
 
 #define LAPACK_REQUIRE_EXTERN
+#define ITENSOR_USE_ZGEMM
 
 namespace itensor {
     using LAPACK_INT = int;
@@ -45,6 +46,7 @@ namespace itensor {
 #elif defined PLATFORM_openblas
 
 #define ITENSOR_USE_CBLAS
+#define ITENSOR_USE_ZGEMM
 
 #include "cblas.h"
 #include "lapacke.h"
@@ -103,6 +105,7 @@ imagRef(LAPACK_COMPLEX & z)
 
 #define ITENSOR_USE_CBLAS
 #define ITENSOR_USE_ZGEMM
+#define ITENSOR_USE_GEMM_BATCH
 
 #include "mkl_cblas.h"
 #include "mkl_lapack.h"
@@ -308,6 +311,31 @@ void F77NAME(zgesdd)(char *jobz, LAPACK_INT *m, LAPACK_INT *n, LAPACK_COMPLEX *a
              LAPACK_COMPLEX *work, LAPACK_INT *lwork, double *rwork, LAPACK_INT *iwork, LAPACK_INT *info);
 #endif
 
+#ifdef PLATFORM_acml
+void F77NAME(dgesdd)(char *jobz, int *m, int *n, double *a, int *lda, double *s,
+             double *u, int *ldu, double *vt, int *ldvt,
+             double *work, int *lwork, int *iwork, int *info,
+             int jobz_len);
+void F77NAME(dgesvd)(char *jobu, char *jobvt, int *m, int *n, double *a, int *lda, double *s,
+             double *u, int *ldu, double *vt, int *ldvt,
+             double *work, int *lwork, int *info,
+             int jobu_len, int jobvt_len);
+void F77NAME(zgesvd)(char *jobu, char *jobvt, int *m, int *n, LAPACK_COMPLEX *a, int *lda, double *s,
+             LAPACK_COMPLEX *u, int *ldu, LAPACK_COMPLEX *vt, int *ldvt,
+             LAPACK_COMPLEX *work, int *lwork, double *rwork, int *info,
+             int jobu_len, int jobvt_len);
+#else
+void F77NAME(dgesdd)(char *jobz, LAPACK_INT *m, LAPACK_INT *n, double *a, LAPACK_INT *lda, double *s,
+             double *u, LAPACK_INT *ldu, double *vt, LAPACK_INT *ldvt,
+             double *work, LAPACK_INT *lwork, LAPACK_INT *iwork, LAPACK_INT *info);
+void F77NAME(dgesvd)(char *jobu, char *jobvt, LAPACK_INT *m, LAPACK_INT *n, double *a, LAPACK_INT *lda, double *s,
+             double *u, LAPACK_INT *ldu, double *vt, LAPACK_INT *ldvt,
+             double *work, LAPACK_INT *lwork, LAPACK_INT *info);
+void F77NAME(zgesvd)(char *jobu, char *jobvt, LAPACK_INT *m, LAPACK_INT *n, LAPACK_COMPLEX *a, LAPACK_INT *lda, double *s,
+             LAPACK_COMPLEX *u, LAPACK_INT *ldu, LAPACK_COMPLEX *vt, LAPACK_INT *ldvt,
+             LAPACK_COMPLEX *work, LAPACK_INT *lwork, double *rwork, LAPACK_INT *info);
+#endif
+
 void F77NAME(dgeqrf)(LAPACK_INT *m, LAPACK_INT *n, double *a, LAPACK_INT *lda, 
                      double *tau, double *work, LAPACK_INT *lwork, LAPACK_INT *info);
 
@@ -440,6 +468,25 @@ gemm_wrapper(bool transa,
              Cplx beta,
              Cplx * C);
 
+#ifdef ITENSOR_USE_GEMM_BATCH
+//
+// dgemm_batch - count products
+// all having the same m, n, k
+//
+void
+gemm_batch_wrapper(bool transa, 
+                   bool transb,
+                   LAPACK_INT m,
+                   LAPACK_INT n,
+                   LAPACK_INT k,
+                   LAPACK_REAL alpha,
+                   LAPACK_REAL const* const* A,
+                   LAPACK_REAL const* const* B,
+                   LAPACK_REAL beta,
+                   LAPACK_REAL * const* C,
+                   LAPACK_INT count);
+#endif
+
 //
 // dgemv - matrix*vector multiply
 //
@@ -502,6 +549,52 @@ zgesdd_wrapper(char *jobz,           //char* specifying how much of U, V to comp
                LAPACK_COMPLEX *vt,   //on return, unitary matrix V transpose
                LAPACK_INT *info);
 
+//
+// gesdd, gesvd
+//
+// Singular value decomposition A = U*diag(s)*VT of the
+// m x n column-major matrix A, computing the min(m,n)
+// leading columns of U (m x min(m,n)) and rows of VT
+// (min(m,n) x n), using either the divide-and-conquer
+// driver (?gesdd) or the QR iteration driver (?gesvd).
+// A is overwritten. Optimal workspace sizes are cached
+// per thread for each driver and shape, so repeated
+// calls for the same shape skip the workspace query.
+//
+// Returns the "info" integer (0 on success)
+//
+LAPACK_INT
+gesdd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              LAPACK_REAL* A,
+              LAPACK_REAL* s,
+              LAPACK_REAL* u,
+              LAPACK_REAL* vt);
+
+LAPACK_INT
+gesdd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              Cplx* A,
+              LAPACK_REAL* s,
+              Cplx* u,
+              Cplx* vt);
+
+LAPACK_INT
+gesvd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              LAPACK_REAL* A,
+              LAPACK_REAL* s,
+              LAPACK_REAL* u,
+              LAPACK_REAL* vt);
+
+LAPACK_INT
+gesvd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              Cplx* A,
+              LAPACK_REAL* s,
+              Cplx* u,
+              Cplx* vt);
+
 //
 // dgeqrf
 //
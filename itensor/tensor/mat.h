@@ -111,6 +111,18 @@ gemm(MatRefc<VA> A,
      Real alpha,
      Real beta);
 
+//Floating point operations done by gemm
+//to multiply an m x k by a k x n matrix
+template<typename VA, typename VB>
+Real
+gemmFlops(size_t m, size_t n, size_t k)
+    {
+    auto f = 2.*m*n*k;
+    if(isCplx<VA>() && isCplx<VB>()) return 4*f;
+    if(isCplx<VA>() || isCplx<VB>()) return 2*f;
+    return f;
+    }
+
 template<typename VA, typename VB>
 void
 mult(MatRefc<VA> A, 
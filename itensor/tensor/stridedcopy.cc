@@ -0,0 +1,226 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <algorithm>
+#include "itensor/tensor/stridedcopy.h"
+#include "itensor/util/args.h"
+#include "itensor/util/iterate.h"
+#include "itensor/util/threadpool.h"
+
+namespace itensor {
+
+//Copies with fewer elements than this
+//are not split over threads
+long constexpr
+stridedCopyThreadSize() { return 1l << 18; }
+
+//A dimension of the copy
+struct CopyDim
+    {
+    long ext = 1,
+         fstr = 0,
+         tstr = 0;
+    };
+
+//Outer loop of the copy: an odometer over
+//the dimensions not handled by the inner kernel
+//(loops[0] changes fastest)
+struct CopyLoop
+    {
+    long n = 1,
+         fstep = 0,
+         tstep = 0;
+    };
+
+using CopyLoops = InfArray<CopyLoop,11ul>;
+
+//Call f(foff,toff,count) for outer iterations
+//begin,...,end-1 where count holds the current
+//value of each loop counter
+template<typename F>
+void
+runLoops(CopyLoops const& loops,
+         long begin,
+         long end,
+         F const& f)
+    {
+    auto count = IntArray(loops.size(),0);
+    long foff = 0,
+         toff = 0;
+    auto rem = begin;
+    for(auto k : range(loops))
+        {
+        count[k] = rem % loops[k].n;
+        rem /= loops[k].n;
+        foff += count[k]*loops[k].fstep;
+        toff += count[k]*loops[k].tstep;
+        }
+    for(auto i = begin; i < end; ++i)
+        {
+        f(foff,toff,count);
+        for(auto k : range(loops))
+            {
+            auto& L = loops[k];
+            ++count[k];
+            foff += L.fstep;
+            toff += L.tstep;
+            if(count[k] < L.n) break;
+            count[k] = 0;
+            foff -= L.n*L.fstep;
+            toff -= L.n*L.tstep;
+            }
+        }
+    }
+
+template<typename F>
+void
+splitLoops(CopyLoops const& loops,
+           long size,
+           F const& f)
+    {
+    long nouter = 1;
+    for(auto& L : loops) nouter *= L.n;
+
+    auto nthread = 1;
+    if(size >= stridedCopyThreadSize() && nouter > 1)
+        {
+        nthread = Args::global().getInt("NThread",1);
+        }
+    if(nthread <= 1)
+        {
+        runLoops(loops,0,nouter,f);
+        return;
+        }
+    auto ntask = std::min(nouter,4l*nthread);
+    threadPool(nthread).run(ntask,[&loops,&f,nouter,ntask](long t)
+        {
+        runLoops(loops,(t*nouter)/ntask,((t+1)*nouter)/ntask,f);
+        },nthread);
+    }
+
+template<typename T>
+void
+stridedCopy(IntArray const& ext,
+            T const* from,
+            IntArray const& fstr,
+            T* to,
+            IntArray const& tstr)
+    {
+    //Drop dimensions of extent 1 and merge dimensions
+    //which are contiguous in both from and to
+    auto dims = InfArray<CopyDim,11ul>{};
+    long size = 1;
+    for(auto n : range(ext))
+        {
+        size *= ext[n];
+        if(ext[n] == 1) continue;
+        auto d = CopyDim{};
+        d.ext = ext[n];
+        d.fstr = fstr[n];
+        d.tstr = tstr[n];
+        dims.push_back(d);
+        }
+    if(size == 0) return;
+    std::sort(dims.begin(),dims.end(),
+              [](CopyDim const& a, CopyDim const& b) { return a.tstr < b.tstr; });
+    auto nd = 0ul;
+    for(auto n : range(dims))
+        {
+        if(nd > 0)
+            {
+            auto& p = dims[nd-1];
+            if(dims[n].fstr == p.ext*p.fstr && dims[n].tstr == p.ext*p.tstr)
+                {
+                p.ext *= dims[n].ext;
+                continue;
+                }
+            }
+        dims[nd++] = dims[n];
+        }
+    dims.resize(nd);
+
+    if(dims.empty())
+        {
+        *to = *from;
+        return;
+        }
+
+    //Fastest dimension of to is dims[0];
+    //find the fastest dimension of from
+    auto a = 0ul;
+    for(auto n : range(dims)) if(dims[n].fstr < dims[a].fstr) a = n;
+
+    auto loops = CopyLoops{};
+    if(a == 0)
+        {
+        //Fastest dimension is the same for from and to:
+        //copy along it, looping over the others
+        for(auto n : range(1ul,dims.size()))
+            {
+            loops.push_back(CopyLoop{dims[n].ext,dims[n].fstr,dims[n].tstr});
+            }
+        auto d = dims[0];
+        splitLoops(loops,size,[d,from,to](long foff, long toff, IntArray const&)
+            {
+            auto* f = from+foff;
+            auto* t = to+toff;
+            if(d.fstr == 1 && d.tstr == 1)
+                {
+                std::copy(f,f+d.ext,t);
+                }
+            else
+                {
+                for(long i = 0; i < d.ext; ++i) t[i*d.tstr] = f[i*d.fstr];
+                }
+            });
+        return;
+        }
+
+    //Transpose dims[0] (fastest in to) against dims[a]
+    //(fastest in from) in tiles of tile x tile elements;
+    //the first two loops step over the tiles
+    auto tile = (sizeof(T) <= 8) ? 32l : 16l;
+    auto d0 = dims[0],
+         da = dims[a];
+    loops.push_back(CopyLoop{(d0.ext+tile-1)/tile,tile*d0.fstr,tile*d0.tstr});
+    loops.push_back(CopyLoop{(da.ext+tile-1)/tile,tile*da.fstr,tile*da.tstr});
+    for(auto n : range(1ul,dims.size()))
+        {
+        if(n == a) continue;
+        loops.push_back(CopyLoop{dims[n].ext,dims[n].fstr,dims[n].tstr});
+        }
+    splitLoops(loops,size,[d0,da,tile,from,to](long foff, long toff, IntArray const& count)
+        {
+        auto n0 = std::min(tile,d0.ext-count[0]*tile);
+        auto na = std::min(tile,da.ext-count[1]*tile);
+        for(long j = 0; j < na; ++j)
+            {
+            auto* f = from+foff+j*da.fstr;
+            auto* t = to+toff+j*da.tstr;
+            if(d0.tstr == 1)
+                {
+                for(long i = 0; i < n0; ++i) t[i] = f[i*d0.fstr];
+                }
+            else
+                {
+                for(long i = 0; i < n0; ++i) t[i*d0.tstr] = f[i*d0.fstr];
+                }
+            }
+        });
+    }
+template void stridedCopy(IntArray const&,Real const*,IntArray const&,Real*,IntArray const&);
+template void stridedCopy(IntArray const&,Cplx const*,IntArray const&,Cplx*,IntArray const&);
+
+} //namespace itensor
@@ -0,0 +1,50 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_STRIDEDCOPY_H
+#define __ITENSOR_STRIDEDCOPY_H
+
+#include "itensor/tensor/types.h"
+
+namespace itensor {
+
+//
+// Copy a tensor with extents ext and strides fstr
+// starting at from into memory starting at to
+// with strides tstr (such as a permuted copy).
+//
+// o Dimensions which are contiguous in both from
+//   and to are merged, so a permutation which
+//   keeps the leading dimensions in place is
+//   a loop over contiguous copies.
+// o Otherwise the two dimensions with unit (or
+//   smallest) stride in from and in to are
+//   transposed in tiles small enough to stay
+//   in L1 cache, with the inner loop writing
+//   contiguous elements of to.
+// o If "NThread" in Args::global() is more than one,
+//   large copies are split over the shared thread pool.
+//
+template<typename T>
+void
+stridedCopy(IntArray const& ext,
+            T const* from,
+            IntArray const& fstr,
+            T* to,
+            IntArray const& tstr);
+
+} //namespace itensor
+
+#endif
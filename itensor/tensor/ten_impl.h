@@ -159,12 +159,63 @@ transform(TenRefc<R1,T1> const& from,
         }
     }
 
+namespace detail {
+
+template<typename R1, typename R2, typename T>
+void
+copyData(TenRefc<R2,T> const& from,
+         TenRef<R1,T>  const& to)
+    {
+    transform(from,to,[](T b, T& a){ a = b; });
+    }
+
+//Real and complex data (including permuted copies
+//made by contract) use the cache-blocked stridedCopy
+template<typename R1, typename R2, typename T>
+void
+stridedCopyData(TenRefc<R2,T> const& from,
+                TenRef<R1,T>  const& to)
+    {
+#ifdef DEBUG
+    checkCompatible(to,from,"operator&=");
+#endif 
+    auto r = to.order();
+    auto ext = IntArray(r),
+         fstr = IntArray(r),
+         tstr = IntArray(r);
+    for(decltype(r) n = 0; n < r; ++n)
+        {
+        ext[n] = from.extent(n);
+        fstr[n] = from.stride(n);
+        tstr[n] = to.stride(n);
+        }
+    stridedCopy(ext,from.data(),fstr,to.data(),tstr);
+    }
+
+template<typename R1, typename R2>
+void
+copyData(TenRefc<R2,Real> const& from,
+         TenRef<R1,Real>  const& to)
+    {
+    stridedCopyData(from,to);
+    }
+
+template<typename R1, typename R2>
+void
+copyData(TenRefc<R2,Cplx> const& from,
+         TenRef<R1,Cplx>  const& to)
+    {
+    stridedCopyData(from,to);
+    }
+
+} //namespace detail
+
 //Assign to referenced data
 template<typename R1, typename R2, typename T>
 void 
 operator&=(TenRef<R1,T> const& A, TenRefc<R2,T> const& B)
     {
-    transform(B,A,[](T b, T& a){ a = b; });
+    detail::copyData(B,A);
     }
 
 //Assign to referenced data
@@ -172,7 +223,7 @@ template<typename R1, typename R2, typename T>
 void
 operator&=(TenRef<R1,T> const& A, Ten<R2,T> const& B)
     {
-    transform(makeRef(B),A,[](T b, T& a){ a = b; });
+    detail::copyData(makeRef(B),A);
     }
 
 template<typename R1, typename R2,typename T>
@@ -0,0 +1,158 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "itensor/util/counters.h"
+#include "itensor/util/profiler.h"
+
+namespace itensor {
+
+//Counters written only by their owning thread,
+//so updates need not be atomic read-modify-writes
+struct ThreadCounts
+    {
+    std::atomic<Real> flops{0};
+    std::atomic<long> ngemm{0};
+    std::atomic<long> ncontract{0};
+    std::atomic<long> nalloc{0};
+    std::atomic<Real> bytes_alloc{0};
+    };
+
+template<typename T, typename V>
+void
+bump(std::atomic<T> & c, V val)
+    {
+    c.store(c.load(std::memory_order_relaxed)+val,std::memory_order_relaxed);
+    }
+
+struct CountRegistry
+    {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadCounts>> threads;
+    //Totals at the last reset
+    OpCounts base;
+    //Tensor storage is often freed by a different
+    //thread than allocated it, so these are shared
+    std::atomic<long long> live{0};
+    std::atomic<long long> peak{0};
+    };
+
+//Never destroyed, since tensors held in static
+//variables can be freed after it would be
+CountRegistry static&
+countRegistry()
+    {
+    static auto* reg = new CountRegistry;
+    return *reg;
+    }
+
+ThreadCounts static&
+threadCounts()
+    {
+    static thread_local std::shared_ptr<ThreadCounts> tc;
+    if(!tc)
+        {
+        tc = std::make_shared<ThreadCounts>();
+        auto& reg = countRegistry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.threads.push_back(tc);
+        }
+    return *tc;
+    }
+
+OpCounts static
+totalCounts(CountRegistry & reg)
+    {
+    auto t = OpCounts{};
+    for(auto& tc : reg.threads)
+        {
+        t.flops += tc->flops.load();
+        t.ngemm += tc->ngemm.load();
+        t.ncontract += tc->ncontract.load();
+        t.nalloc += tc->nalloc.load();
+        t.bytes_alloc += tc->bytes_alloc.load();
+        }
+    return t;
+    }
+
+OpCounts
+opCounts()
+    {
+    auto& reg = countRegistry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    auto t = totalCounts(reg);
+    t.flops -= reg.base.flops;
+    t.ngemm -= reg.base.ngemm;
+    t.ncontract -= reg.base.ncontract;
+    t.nalloc -= reg.base.nalloc;
+    t.bytes_alloc -= reg.base.bytes_alloc;
+    t.live_bytes = reg.live.load();
+    t.peak_bytes = reg.peak.load();
+    return t;
+    }
+
+void
+resetOpCounts()
+    {
+    auto& reg = countRegistry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.base = totalCounts(reg);
+    reg.peak.store(reg.live.load());
+    }
+
+void
+countGemm(Real flops, Real bytes, long nmult)
+    {
+    auto& tc = threadCounts();
+    bump(tc.flops,flops);
+    bump(tc.ngemm,nmult);
+    profileCount(flops,bytes);
+    }
+
+void
+countFlops(Real flops)
+    {
+    bump(threadCounts().flops,flops);
+    profileCount(flops);
+    }
+
+void
+countContract()
+    {
+    bump(threadCounts().ncontract,1);
+    }
+
+void
+countAlloc(size_t bytes)
+    {
+    auto& tc = threadCounts();
+    bump(tc.nalloc,1);
+    bump(tc.bytes_alloc,bytes);
+    auto& reg = countRegistry();
+    auto live = reg.live.fetch_add(bytes)+(long long)bytes;
+    auto peak = reg.peak.load();
+    while(live > peak && !reg.peak.compare_exchange_weak(peak,live)) { }
+    }
+
+void
+countFree(size_t bytes)
+    {
+    countRegistry().live.fetch_sub(bytes);
+    }
+
+} //namespace itensor
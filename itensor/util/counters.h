@@ -0,0 +1,84 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_COUNTERS_H
+#define __ITENSOR_COUNTERS_H
+
+#include <cstddef>
+#include "itensor/real.h"
+
+namespace itensor {
+
+//
+// Operation counters
+//
+// Counts of the work done by ITensor operations, which
+// are always on (each count is an add to a counter owned
+// by the calling thread). opCounts() returns the totals
+// over all threads since the last resetOpCounts():
+//
+// o flops - floating point operations done by gemm
+//   (so including dense and block-sparse contractions)
+//   and estimated for the Hermitian eigensolver used by
+//   diagHermitian and svd
+// o ngemm - number of matrix products
+// o ncontract - number of ITensor contractions
+// o nalloc, bytes_alloc - number and total size of
+//   tensor storage allocations
+// o live_bytes - bytes of tensor storage currently alive
+// o peak_bytes - most bytes of tensor storage alive at
+//   once since the last reset
+//
+// Flops are also added to the innermost scope of the
+// runtime profiler (see util/profiler.h) if it is on.
+//
+struct OpCounts
+    {
+    Real flops = 0;
+    long ngemm = 0;
+    long ncontract = 0;
+    long nalloc = 0;
+    Real bytes_alloc = 0;
+    Real live_bytes = 0;
+    Real peak_bytes = 0;
+    };
+
+OpCounts
+opCounts();
+
+void
+resetOpCounts();
+
+//Count nmult matrix products doing flops in total,
+//moving bytes (for the profiler)
+void
+countGemm(Real flops, Real bytes = 0, long nmult = 1);
+
+//Count flops done by other operations
+void
+countFlops(Real flops);
+
+void
+countContract();
+
+void
+countAlloc(size_t bytes);
+
+void
+countFree(size_t bytes);
+
+} //namespace itensor
+
+#endif
@@ -0,0 +1,364 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "itensor/util/profiler.h"
+#include "itensor/util/print.h"
+#include "itensor/util/error.h"
+
+namespace itensor {
+
+namespace detail {
+
+struct ProfileNode
+    {
+    const char* name = "";
+    ProfileNode* parent = nullptr;
+    std::vector<std::unique_ptr<ProfileNode>> children;
+    long count = 0;
+    Real time = 0;
+    Real flops = 0;
+    Real bytes = 0;
+    };
+
+} //namespace detail
+
+using detail::ProfileNode;
+
+using profile_clock = std::chrono::steady_clock;
+
+struct TraceEvent
+    {
+    const char* name;
+    Real start; //microseconds
+    Real dur;
+    };
+
+//Trace events kept per thread
+size_t constexpr
+maxTraceEvents() { return 1ul << 20; }
+
+struct ThreadProfile
+    {
+    int tid = 0;
+    ProfileNode root;
+    ProfileNode* current = &root;
+    std::vector<TraceEvent> events;
+    size_t ndropped = 0;
+    };
+
+struct ProfileRegistry
+    {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadProfile>> threads;
+    profile_clock::time_point start = profile_clock::now();
+    std::atomic<bool> tracing{false};
+    };
+
+ProfileRegistry static&
+registry()
+    {
+    static ProfileRegistry reg;
+    return reg;
+    }
+
+ThreadProfile static&
+threadProfile()
+    {
+    static thread_local std::shared_ptr<ThreadProfile> tp;
+    if(!tp)
+        {
+        tp = std::make_shared<ThreadProfile>();
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        tp->tid = int(reg.threads.size());
+        reg.threads.push_back(tp);
+        }
+    return *tp;
+    }
+
+void detail::
+profileAdd(Real flops, Real bytes)
+    {
+    auto& n = *threadProfile().current;
+    n.flops += flops;
+    n.bytes += bytes;
+    }
+
+void ProfileScope::
+begin(const char* name)
+    {
+    auto& tp = threadProfile();
+    auto* parent = tp.current;
+    for(auto& c : parent->children)
+        {
+        if(c->name == name || std::strcmp(c->name,name) == 0)
+            {
+            node_ = c.get();
+            break;
+            }
+        }
+    if(!node_)
+        {
+        parent->children.emplace_back(new ProfileNode);
+        node_ = parent->children.back().get();
+        node_->name = name;
+        node_->parent = parent;
+        }
+    tp.current = node_;
+    start_ = clock_type::now();
+    }
+
+void ProfileScope::
+end()
+    {
+    auto stop = clock_type::now();
+    auto& tp = threadProfile();
+    node_->count += 1;
+    node_->time += std::chrono::duration<Real>(stop-start_).count();
+    tp.current = node_->parent;
+    auto& reg = registry();
+    if(reg.tracing.load(std::memory_order_relaxed))
+        {
+        if(tp.events.size() < maxTraceEvents())
+            {
+            using us = std::chrono::duration<Real,std::micro>;
+            tp.events.push_back({node_->name,
+                                 us(start_-reg.start).count(),
+                                 us(stop-start_).count()});
+            }
+        else
+            {
+            ++tp.ndropped;
+            }
+        }
+    }
+
+//Call tree summed over threads
+struct MergedNode
+    {
+    std::string name;
+    ProfileStats stats;
+    std::vector<MergedNode> children;
+    };
+
+void static
+mergeInto(MergedNode & m, ProfileNode const& n)
+    {
+    m.stats.count += n.count;
+    m.stats.time += n.time;
+    m.stats.flops += n.flops;
+    m.stats.bytes += n.bytes;
+    for(auto& c : n.children)
+        {
+        MergedNode* mc = nullptr;
+        for(auto& x : m.children) if(x.name == c->name) mc = &x;
+        if(!mc)
+            {
+            m.children.emplace_back();
+            mc = &m.children.back();
+            mc->name = c->name;
+            }
+        mergeInto(*mc,*c);
+        }
+    }
+
+//Make flops and bytes inclusive of children
+void static
+accumulate(MergedNode & m)
+    {
+    for(auto& c : m.children)
+        {
+        accumulate(c);
+        m.stats.flops += c.stats.flops;
+        m.stats.bytes += c.stats.bytes;
+        }
+    }
+
+MergedNode static
+mergedTree()
+    {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    auto m = MergedNode{};
+    for(auto& tp : reg.threads) mergeInto(m,tp->root);
+    accumulate(m);
+    return m;
+    }
+
+void static
+resetNode(ProfileNode & n)
+    {
+    n.count = 0;
+    n.time = 0;
+    n.flops = 0;
+    n.bytes = 0;
+    for(auto& c : n.children) resetNode(*c);
+    }
+
+void Profiler::
+enable(bool val)
+    {
+    detail::profile_enabled.store(val);
+    }
+
+void Profiler::
+trace(bool val)
+    {
+    registry().tracing.store(val);
+    if(val) enable();
+    }
+
+bool Profiler::
+tracing() const
+    {
+    return registry().tracing.load();
+    }
+
+void Profiler::
+reset()
+    {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for(auto& tp : reg.threads)
+        {
+        resetNode(tp->root);
+        tp->events.clear();
+        tp->ndropped = 0;
+        }
+    reg.start = profile_clock::now();
+    }
+
+ProfileStats Profiler::
+stats(std::string const& path) const
+    {
+    auto m = mergedTree();
+    MergedNode const* n = &m;
+    size_t pos = 0;
+    while(n && pos <= path.size())
+        {
+        auto next = path.find('/',pos);
+        if(next == std::string::npos) next = path.size();
+        auto name = path.substr(pos,next-pos);
+        pos = next+1;
+        if(name.empty()) continue;
+        MergedNode const* child = nullptr;
+        for(auto& c : n->children) if(c.name == name) child = &c;
+        n = child;
+        }
+    if(!n || n == &m) return ProfileStats{};
+    return n->stats;
+    }
+
+void static
+printNode(std::ostream & s,
+          MergedNode const& n,
+          int depth,
+          Real total)
+    {
+    auto name = std::string(2*depth,' ')+n.name;
+    auto& st = n.stats;
+    auto pct = total > 0 ? 100*st.time/total : 0.;
+    auto gflops = st.time > 0 ? 1E-9*st.flops/st.time : 0.;
+    s << format("%-32s %10d %11.4f %6.1f %11.3f %8.2f %10.3f\n",
+                name,st.count,st.time,pct,1E-9*st.flops,gflops,1E-9*st.bytes);
+    for(auto& c : n.children) printNode(s,c,depth+1,total);
+    }
+
+void Profiler::
+print(std::ostream & s) const
+    {
+    auto m = mergedTree();
+    Real total = 0;
+    for(auto& c : m.children) total += c.stats.time;
+    s << "Profile (times in seconds, flops and bytes include sub-scopes)\n";
+    s << format("%-32s %10s %11s %6s %11s %8s %10s\n",
+                "scope","calls","time","%","GFlop","GFlop/s","GB");
+    for(auto& c : m.children) printNode(s,c,0,total);
+    }
+
+void Profiler::
+writeTrace(std::string const& fname) const
+    {
+    std::ofstream f(fname);
+    if(!f) Error(format("writeTrace: could not open file \"%s\"",fname));
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    f << "{\"traceEvents\":[";
+    auto first = true;
+    size_t ndropped = 0;
+    for(auto& tp : reg.threads)
+        {
+        for(auto& e : tp->events)
+            {
+            if(!first) f << ",";
+            first = false;
+            f << format("\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                        e.name,tp->tid,e.start,e.dur);
+            }
+        ndropped += tp->ndropped;
+        }
+    f << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << ndropped << "}}\n";
+    }
+
+Profiler&
+profiler()
+    {
+    static Profiler p;
+    return p;
+    }
+
+//Turns the profiler on if the environment
+//variable ITENSOR_PROFILE is set, reporting
+//the results when the program exits
+struct ProfileFromEnv
+    {
+    std::string tracefile;
+    bool on = false;
+
+    ProfileFromEnv()
+        {
+        auto* val = std::getenv("ITENSOR_PROFILE");
+        if(!val || std::strlen(val) == 0 || std::strcmp(val,"0") == 0) return;
+        on = true;
+        registry();
+        profiler().enable();
+        auto v = std::string(val);
+        if(v.size() > 5 && v.substr(v.size()-5) == ".json")
+            {
+            tracefile = v;
+            profiler().trace();
+            }
+        }
+
+    ~ProfileFromEnv()
+        {
+        if(!on) return;
+        profiler().enable(false);
+        profiler().print(std::cout);
+        if(!tracefile.empty()) profiler().writeTrace(tracefile);
+        }
+    };
+
+ProfileFromEnv static profile_from_env_;
+
+} //namespace itensor
@@ -0,0 +1,159 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_PROFILER_H
+#define __ITENSOR_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include "itensor/real.h"
+
+//
+// Runtime profiler
+//
+// o PROFILE_SCOPE("name") times the rest of the enclosing
+//   block as a child of the scope already open on the
+//   calling thread, so nested scopes build a call tree
+//   (for example dmrg/sweep/bond/davidson/product/contract/gemm).
+//   The name must be a string literal (or otherwise outlive
+//   the profiler).
+// o profileCount(flops,bytes) adds floating point operations
+//   and bytes moved to the innermost open scope.
+// o Profiling is off by default, when a scope costs a single
+//   atomic load. Turn it on with profiler().enable(), or by
+//   setting the environment variable ITENSOR_PROFILE, which
+//   prints a summary when the program exits (if its value
+//   ends in ".json" a Chrome trace is also written there).
+// o profiler().print(s) prints a summary table and
+//   profiler().writeTrace(fname) writes the recorded scopes
+//   in Chrome trace format (open in chrome://tracing or
+//   ui.perfetto.dev). Call them, and reset(), while no
+//   profiled code is running on other threads.
+//
+// Each thread has its own call tree; scopes entered on
+// thread pool workers appear under the scopes opened on
+// that worker (usually at the top level).
+//
+
+#define ITENSOR_PROFILE_CAT2(A,B) A##B
+#define ITENSOR_PROFILE_CAT(A,B) ITENSOR_PROFILE_CAT2(A,B)
+#define PROFILE_SCOPE(NAME) itensor::ProfileScope ITENSOR_PROFILE_CAT(profile_scope_,__LINE__)(NAME);
+
+namespace itensor {
+
+namespace detail {
+
+inline std::atomic<bool> profile_enabled{false};
+
+struct ProfileNode;
+
+void
+profileAdd(Real flops, Real bytes);
+
+} //namespace detail
+
+bool inline
+profileEnabled() { return detail::profile_enabled.load(std::memory_order_relaxed); }
+
+void inline
+profileCount(Real flops, Real bytes = 0)
+    {
+    if(profileEnabled()) detail::profileAdd(flops,bytes);
+    }
+
+class ProfileScope
+    {
+    using clock_type = std::chrono::steady_clock;
+    detail::ProfileNode* node_ = nullptr;
+    clock_type::time_point start_;
+    public:
+
+    explicit
+    ProfileScope(const char* name)
+        {
+        if(profileEnabled()) begin(name);
+        }
+
+    ProfileScope(ProfileScope const&) = delete;
+    ProfileScope& operator=(ProfileScope const&) = delete;
+
+    ~ProfileScope()
+        {
+        if(node_) end();
+        }
+
+    private:
+
+    void
+    begin(const char* name);
+
+    void
+    end();
+    };
+
+//Totals for one scope of the call tree,
+//summed over threads. Flops and bytes include
+//those counted by the scope's children.
+struct ProfileStats
+    {
+    long count = 0;
+    Real time = 0;
+    Real flops = 0;
+    Real bytes = 0;
+    };
+
+class Profiler
+    {
+    public:
+
+    void
+    enable(bool val = true);
+
+    bool
+    enabled() const { return profileEnabled(); }
+
+    //Record every scope for writeTrace
+    //(off by default; implies enable)
+    void
+    trace(bool val = true);
+
+    bool
+    tracing() const;
+
+    //Zero all times and counts and
+    //drop recorded trace events
+    void
+    reset();
+
+    //Stats for the scope with the given path of names
+    //from the top of the tree, such as "dmrg/sweep/bond"
+    ProfileStats
+    stats(std::string const& path) const;
+
+    void
+    print(std::ostream & s) const;
+
+    void
+    writeTrace(std::string const& fname) const;
+    };
+
+Profiler&
+profiler();
+
+} //namespace itensor
+
+#endif
@@ -0,0 +1,118 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <atomic>
+#include "itensor/util/scratch.h"
+
+namespace itensor {
+
+struct ScratchArena
+    {
+    std::unique_ptr<Real[]> buf;
+    size_t size = 0;
+    bool inuse = false;
+    };
+
+ScratchArena static&
+scratchArena()
+    {
+    static thread_local ScratchArena arena;
+    return arena;
+    }
+
+std::atomic<size_t> static max_bytes_{1ul << 30};
+
+std::atomic<unsigned long long> static nreuse_{0},
+                                       nalloc_{0},
+                                       bytes_avoided_{0};
+
+ScratchBuffer::
+ScratchBuffer(size_t size)
+  : size_(size)
+    {
+    if(size == 0) return;
+    auto& arena = scratchArena();
+    auto max_size = max_bytes_.load()/sizeof(Real);
+    if(arena.inuse || size > max_size)
+        {
+        heap_.reset(new Real[size]);
+        data_ = heap_.get();
+        ++nalloc_;
+        return;
+        }
+    if(arena.size < size)
+        {
+        arena.buf.reset();
+        arena.buf.reset(new Real[size]);
+        arena.size = size;
+        ++nalloc_;
+        }
+    else
+        {
+        ++nreuse_;
+        bytes_avoided_ += size*sizeof(Real);
+        }
+    arena.inuse = true;
+    data_ = arena.buf.get();
+    }
+
+ScratchBuffer::
+~ScratchBuffer()
+    {
+    if(!data_ || heap_) return;
+    auto& arena = scratchArena();
+    arena.inuse = false;
+    //Shrink if the maximum was lowered
+    //since the arena grew
+    if(arena.size*sizeof(Real) > max_bytes_.load()) releaseScratch();
+    }
+
+size_t
+scratchMaxBytes() { return max_bytes_.load(); }
+
+void
+setScratchMaxBytes(size_t nbytes) { max_bytes_ = nbytes; }
+
+void
+releaseScratch()
+    {
+    auto& arena = scratchArena();
+    if(arena.inuse) return;
+    arena.buf.reset();
+    arena.size = 0;
+    }
+
+size_t
+scratchBytes() { return scratchArena().size*sizeof(Real); }
+
+ScratchStats
+scratchStats()
+    {
+    auto s = ScratchStats{};
+    s.nreuse = nreuse_.load();
+    s.nalloc = nalloc_.load();
+    s.bytesAvoided = bytes_avoided_.load();
+    return s;
+    }
+
+void
+resetScratchStats()
+    {
+    nreuse_ = 0;
+    nalloc_ = 0;
+    bytes_avoided_ = 0;
+    }
+
+} //namespace itensor
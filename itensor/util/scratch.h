@@ -0,0 +1,97 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_SCRATCH_H
+#define __ITENSOR_SCRATCH_H
+
+#include <cstddef>
+#include <memory>
+#include "itensor/real.h"
+
+namespace itensor {
+
+//
+// ScratchBuffer - temporary memory for
+// short-lived intermediate results,
+// such as the permuted copies made by contract
+//
+// o ScratchBuffer buf(n) provides space for n Reals
+//   (contents uninitialized) taken from the calling
+//   thread's scratch arena, which grows to the
+//   largest size asked for and is kept for reuse.
+// o If the arena is already in use, or n Reals
+//   are more than scratchMaxBytes(), the buffer
+//   is allocated on the heap instead.
+//
+class ScratchBuffer
+    {
+    Real* data_ = nullptr;
+    size_t size_ = 0;
+    std::unique_ptr<Real[]> heap_;
+    public:
+
+    explicit
+    ScratchBuffer(size_t size);
+
+    ScratchBuffer(ScratchBuffer const&) = delete;
+    ScratchBuffer& operator=(ScratchBuffer const&) = delete;
+
+    ~ScratchBuffer();
+
+    Real*
+    data() { return data_; }
+
+    size_t
+    size() const { return size_; }
+    };
+
+//Largest arena kept per thread, in bytes
+//(default 1GB)
+size_t
+scratchMaxBytes();
+
+void
+setScratchMaxBytes(size_t nbytes);
+
+//Free the calling thread's arena
+void
+releaseScratch();
+
+//Bytes held by the calling thread's arena
+size_t
+scratchBytes();
+
+struct ScratchStats
+    {
+    //Number of ScratchBuffers which reused
+    //an arena without allocating
+    unsigned long long nreuse = 0;
+    //Number which had to allocate (to grow
+    //an arena or on the heap)
+    unsigned long long nalloc = 0;
+    //Total bytes handed out without allocating
+    unsigned long long bytesAvoided = 0;
+    };
+
+//Totals over all threads
+ScratchStats
+scratchStats();
+
+void
+resetScratchStats();
+
+} //namespace itensor
+
+#endif
@@ -0,0 +1,151 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <algorithm>
+#include "itensor/util/threadpool.h"
+
+namespace itensor {
+
+ThreadPool::
+ThreadPool(int nthread)
+    {
+    for(int n = 1; n < nthread; ++n)
+        {
+        workers_.emplace_back([this]() { workerLoop(0); });
+        }
+    nthread_ = 1+workers_.size();
+    }
+
+ThreadPool::
+~ThreadPool()
+    {
+        {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        }
+    wake_.notify_all();
+    for(auto& w : workers_) w.join();
+    }
+
+void ThreadPool::
+run(long ntask, Task const& f, int nthread)
+    {
+    if(ntask <= 0) return;
+    auto expected = false;
+    if(nthread == 1 || nthread_ == 1 || ntask == 1
+       || !busy_.compare_exchange_strong(expected,true))
+        {
+        for(long n = 0; n < ntask; ++n) f(n);
+        return;
+        }
+    //Use at most nthread-1 workers, and no
+    //more than there are tasks to share
+    long nwake = 0;
+        {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nwake = long(workers_.size());
+        if(nthread > 0) nwake = std::min(nwake,long(nthread)-1);
+        nwake = std::min(nwake,ntask-1);
+        task_ = &f;
+        ntask_ = ntask;
+        next_ = 0;
+        nwake_ = nwake;
+        nrunning_ = 0;
+        ++generation_;
+        }
+    for(long n = 0; n < nwake; ++n) wake_.notify_one();
+
+    //Calling thread works too
+    work();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock,[this]() { return nrunning_ == 0; });
+    task_ = nullptr;
+    nwake_ = 0;
+    busy_ = false;
+    auto error = error_;
+    error_ = nullptr;
+    lock.unlock();
+    if(error) std::rethrow_exception(error);
+    }
+
+void ThreadPool::
+work()
+    {
+    auto& f = *task_;
+    for(auto n = next_++; n < ntask_; n = next_++)
+        {
+        try
+            {
+            f(n);
+            }
+        catch(...)
+            {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(!error_) error_ = std::current_exception();
+            next_ = ntask_;
+            }
+        }
+    }
+
+void ThreadPool::
+grow(int nthread)
+    {
+    std::lock_guard<std::mutex> lock(mutex_);
+    //New workers wait for the next run
+    auto seen = generation_;
+    while(int(1+workers_.size()) < nthread)
+        {
+        workers_.emplace_back([this,seen]() { workerLoop(seen); });
+        }
+    nthread_ = 1+workers_.size();
+    }
+
+void ThreadPool::
+workerLoop(unsigned long seen)
+    {
+    while(true)
+        {
+            {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock,[this,seen]() { return stop_ || generation_ != seen; });
+            if(stop_) return;
+            seen = generation_;
+            //Only the first nwake_ workers to wake take
+            //part, and none once run has finished
+            if(!task_ || nwake_ == 0) continue;
+            --nwake_;
+            ++nrunning_;
+            }
+        work();
+            {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --nrunning_;
+            }
+        done_.notify_one();
+        }
+    }
+
+ThreadPool&
+threadPool(int nthread)
+    {
+    //Never destroyed or replaced, so references
+    //to it stay valid; it only grows in place
+    static auto* pool = new ThreadPool(nthread);
+    if(pool->nthread() < nthread) pool->grow(nthread);
+    return *pool;
+    }
+
+} //namespace itensor
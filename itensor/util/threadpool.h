@@ -0,0 +1,116 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_THREADPOOL_H
+#define __ITENSOR_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace itensor {
+
+//
+// ThreadPool - a fixed set of worker threads
+// which stay alive between calls
+//
+// o pool.run(ntask,f) calls f(0),f(1),...,f(ntask-1)
+//   spread over the workers and the calling thread,
+//   returning once every call has completed.
+//   pool.run(ntask,f,nthread) uses at most nthread
+//   threads (the calling thread and nthread-1 workers),
+//   so a shared pool grown by one caller still keeps
+//   to the thread count asked for by the next.
+// o Tasks are handed out one at a time, so uneven
+//   task sizes still keep all threads busy.
+// o If the pool is already running tasks (a call
+//   from inside a task, or from another thread)
+//   run calls f(0),...,f(ntask-1) on the calling thread.
+// o If a task throws, tasks not yet started are
+//   skipped and run rethrows the first exception
+//   once the running tasks have finished.
+// o Use threadPool(nthread) to get a shared pool
+//   instead of constructing one per call.
+//
+class ThreadPool
+    {
+    public:
+    using Task = std::function<void(long)>;
+    private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_,
+                            done_;
+    Task const* task_ = nullptr;
+    long ntask_ = 0;
+    std::atomic<long> next_{0};
+    long nwake_ = 0;
+    long nrunning_ = 0;
+    unsigned long generation_ = 0;
+    bool stop_ = false;
+    std::atomic<int> nthread_{1};
+    std::atomic<bool> busy_{false};
+    std::exception_ptr error_;
+    public:
+
+    explicit
+    ThreadPool(int nthread);
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    ~ThreadPool();
+
+    //Number of threads, including the calling thread
+    int
+    nthread() const { return nthread_.load(); }
+
+    //True while run is executing tasks
+    bool
+    busy() const { return busy_.load(); }
+
+    //nthread < 1 uses every thread of the pool
+    void
+    run(long ntask,
+        Task const& f,
+        int nthread = 0);
+
+    //Add workers until there are nthread threads
+    //(they take part from the next call to run)
+    void
+    grow(int nthread);
+
+    private:
+
+    void
+    work();
+
+    void
+    workerLoop(unsigned long seen);
+    };
+
+//Shared pool with (at least) nthread threads
+//(the pool is never destroyed or replaced: asking
+//for more threads grows it in place)
+ThreadPool&
+threadPool(int nthread);
+
+} //namespace itensor
+
+#endif
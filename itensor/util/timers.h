@@ -21,6 +21,12 @@
 #include "itensor/util/stdx.h"
 #include "itensor/util/print.h"
 
+//
+// Numbered timers enabled at compile time by
+// defining COLLECT_TIMES. The library itself uses
+// the runtime profiler in itensor/util/profiler.h.
+//
+
 //#define COLLECT_TIMES
 
 #ifdef COLLECT_TIMES
@@ -0,0 +1,58 @@
+#include "itensor/all.h"
+#include "itensor/mps/paralleldmrg.h"
+using namespace itensor;
+
+int
+main(int argc, char* argv[])
+    {
+    //
+    // Start MPI; run with, e.g., mpirun -np 4 ./pdmrg
+    //
+    Environment env(argc,argv);
+
+    int N = 100;
+
+    //
+    // Make the Heisenberg Hamiltonian and the initial
+    // Neel state. Only the copies on the first node are
+    // used: parallelDMRG sends them to the other nodes.
+    //
+    auto sites = SpinHalf(N);
+    auto ampo = AutoMPO(sites);
+    for(auto j : range1(N-1))
+        {
+        ampo += 0.5,"S+",j,"S-",j+1;
+        ampo += 0.5,"S-",j,"S+",j+1;
+        ampo +=     "Sz",j,"Sz",j+1;
+        }
+    auto H = toMPO(ampo);
+
+    auto state = InitState(sites);
+    for(auto i : range1(N))
+        {
+        if(i%2 == 1) state.set(i,"Up");
+        else         state.set(i,"Dn");
+        }
+    auto psi = MPS(state);
+
+    //
+    // Parallel DMRG needs a few more sweeps than
+    // serial DMRG to converge
+    //
+    auto sweeps = Sweeps(16);
+    sweeps.maxdim() = 10,20,40,80,100,200;
+    sweeps.cutoff() = 1E-10;
+    sweeps.niter() = 2;
+    sweeps.noise() = 1E-7,1E-8,0.0;
+    if(env.firstNode()) println(sweeps);
+
+    auto energy = parallelDMRG(psi,H,sweeps,env,{"Quiet",true});
+
+    if(env.firstNode())
+        {
+        printfln("\nGround State Energy = %.10f",energy);
+        printfln("Number of nodes = %d",env.nnodes());
+        }
+
+    return 0;
+    }
@@ -2,6 +2,7 @@
 #include "itensor/util/cputime.h"
 #include "itensor/util/iterate.h"
 #include "itensor/tensor/contract.h"
+#include "itensor/util/scratch.h"
 #include "itensor/util/set_scoped.h"
 #include "itensor/util/args.h"
 #include "itensor/global.h"
@@ -526,6 +527,143 @@ TEST_CASE("Contract Test")
             }
         }
 
+    SECTION("Scratch Arena")
+        {
+        //Contracted index in the middle of A
+        //so A has to be permuted
+        Tensor A(4,5,6),
+               B(5,3),
+               C(4,6,3);
+        randomize(A);
+        randomize(B);
+        auto check = [&]()
+            {
+            for(auto i1 : range(4))
+            for(auto i3 : range(6))
+            for(auto i4 : range(3))
+                {
+                Real val = 0;
+                for(auto i2 : range(5)) val += A(i1,i2,i3)*B(i2,i4);
+                CHECK_CLOSE(C(i1,i3,i4),val);
+                }
+            };
+
+        contract(A,{1,2,3},B,{2,4},C,{1,3,4});
+        check();
+        resetScratchStats();
+        contract(A,{1,2,3},B,{2,4},C,{1,3,4});
+        check();
+        auto stats = scratchStats();
+        CHECK(stats.nreuse == 1);
+        CHECK(stats.nalloc == 0);
+        CHECK(stats.bytesAvoided >= 4*5*6*sizeof(Real));
+
+        //Buffers above the maximum size go on the heap
+        auto max_bytes = scratchMaxBytes();
+        setScratchMaxBytes(0);
+        releaseScratch();
+        CHECK(scratchBytes() == 0);
+        contract(A,{1,2,3},B,{2,4},C,{1,3,4});
+        check();
+        CHECK(scratchStats().nalloc == 1);
+        setScratchMaxBytes(max_bytes);
+        }
+
+    SECTION("Contract Cache")
+        {
+        Tensor A(4,5,6),
+               B(5,3),
+               C(4,6,3),
+               D(6,4,3);
+        randomize(A);
+        randomize(B);
+
+        clearContractCache();
+        resetContractCacheStats();
+        contract(A,{1,2,3},B,{2,4},C,{1,3,4});
+        contract(A,{1,2,3},B,{2,4},D,{3,1,4});
+        contract(A,{1,2,3},B,{2,4},C,{1,3,4});
+        contract(A,{1,2,3},B,{2,4},D,{3,1,4});
+        auto stats = contractCacheStats();
+        CHECK(stats.misses == 2);
+        CHECK(stats.hits == 2);
+        for(auto i1 : range(4))
+        for(auto i3 : range(6))
+        for(auto i4 : range(3))
+            {
+            Real val = 0;
+            for(auto i2 : range(5)) val += A(i1,i2,i3)*B(i2,i4);
+            CHECK_CLOSE(C(i1,i3,i4),val);
+            CHECK_CLOSE(D(i3,i1,i4),val);
+            }
+
+        //Same labels but different extents
+        Tensor A2(2,5,6),
+               C2(2,6,3);
+        randomize(A2);
+        contract(A2,{1,2,3},B,{2,4},C2,{1,3,4});
+        CHECK(contractCacheStats().misses == 3);
+        for(auto i1 : range(2))
+        for(auto i3 : range(6))
+        for(auto i4 : range(3))
+            {
+            Real val = 0;
+            for(auto i2 : range(5)) val += A2(i1,i2,i3)*B(i2,i4);
+            CHECK_CLOSE(C2(i1,i3,i4),val);
+            }
+
+        //Turning the cache off
+        auto maxsize = contractCacheSize();
+        setContractCacheSize(0);
+        resetContractCacheStats();
+        contract(A,{1,2,3},B,{2,4},C,{1,3,4});
+        CHECK(contractCacheStats().hits == 0);
+        CHECK(contractCacheStats().misses == 0);
+        setContractCacheSize(maxsize);
+        }
+
+    SECTION("Threaded Contract")
+        {
+        //Bt has its contracted index last,
+        //so its matrix is transposed in gemm
+        Tensor A(40,64,30),
+               B(64,50),
+               Bt(50,64),
+               C(40,30,50),
+               D(50,40,30),
+               E(40,30,50),
+               F(50,40,30),
+               Cs(40,30,50),
+               Ds(50,40,30),
+               Es(40,30,50),
+               Fs(50,40,30);
+        randomize(A);
+        randomize(B);
+        randomize(Bt);
+        contract(A,{1,2,3},B,{2,4},Cs,{1,3,4});
+        contract(A,{1,2,3},B,{2,4},Ds,{4,1,3});
+        contract(A,{1,2,3},Bt,{4,2},Es,{1,3,4});
+        contract(A,{1,2,3},Bt,{4,2},Fs,{4,1,3});
+
+        auto nthread = Args::global().getInt("NThread",1);
+        Args::global().add("NThread",4);
+        contract(A,{1,2,3},B,{2,4},C,{1,3,4});
+        contract(A,{1,2,3},B,{2,4},D,{4,1,3});
+        contract(A,{1,2,3},Bt,{4,2},E,{1,3,4});
+        contract(A,{1,2,3},Bt,{4,2},F,{4,1,3});
+        Args::global().add("NThread",nthread);
+
+        Real maxdiff = 0;
+        for(auto i : range(C.size()))
+            {
+            maxdiff = std::max(maxdiff,std::fabs(C.data()[i]-Cs.data()[i]));
+            maxdiff = std::max(maxdiff,std::fabs(D.data()[i]-Ds.data()[i]));
+            maxdiff = std::max(maxdiff,std::fabs(E.data()[i]-Es.data()[i]));
+            maxdiff = std::max(maxdiff,std::fabs(F.data()[i]-Fs.data()[i]));
+            }
+        CHECK(maxdiff < 1E-12);
+        }
+
     SECTION("Contract Loop")
         {
         SECTION("Case 1: Bik Akj = Cij")
@@ -1,6 +1,7 @@
 #include "test.h"
 #include "itensor/decomp.h"
 #include "itensor/util/print_macro.h"
+#include "itensor/util/counters.h"
 
 using namespace itensor;
 using namespace std;
@@ -153,6 +154,30 @@ SECTION("ITensor SVD")
         CHECK(hasIndex(V,k));
         }
 
+    SECTION("Randomized")
+        {
+        auto a = Index(60),
+             b = Index(70);
+        auto T = randomITensor(a,b);
+        ITensor U(a),D,V;
+        svd(T,U,D,V);
+        D.apply([](Real x) { return std::pow(x,4); });
+        T = U*D*V;
+        T /= norm(T);
+        auto args = Args("MaxDim",8,"Cutoff",1E-16);
+
+        ITensor U1(a),D1,V1;
+        auto spec1 = svd(T,U1,D1,V1,args);
+        ITensor U2(a),D2,V2;
+        auto spec2 = svd(T,U2,D2,V2,{args,"RandomSVD",true});
+        CHECK(dim(commonIndex(U2,D2)) == 8);
+        //Error is close to that of the optimal truncation
+        auto err1 = sqr(norm(T-U1*D1*V1)),
+             err2 = sqr(norm(T-U2*D2*V2));
+        CHECK(err2 < (1+1E-3)*err1);
+        CHECK(std::fabs(spec2.truncerr()-spec1.truncerr()) < 1E-3*spec1.truncerr());
+        }
+
     }
 
 SECTION("QN ITensor SVD")
@@ -195,6 +220,109 @@ SECTION("QN ITensor SVD")
         CHECK(norm(psi-A*D*B) < 1E-12);
         }
 
+    SECTION("Blocks in Parallel")
+        {
+        auto u = Index(QN(+2),6,QN(0),20,QN(-2),9,"u");
+        auto v = Index(QN(+2),11,QN(0),15,QN(-2),4,"v");
+        auto S = randomITensor(QN(),u,v);
+        auto args = Args("MaxDim",20);
+
+        ITensor U1(u),D1,V1;
+        auto spec1 = svd(S,U1,D1,V1,args);
+
+        auto nthread = Args::global().getInt("NThread",1);
+        Args::global().add("NThread",4);
+        ITensor U4(u),D4,V4;
+        auto spec4 = svd(S,U4,D4,V4,args);
+        Args::global().add("NThread",nthread);
+
+        CHECK(dim(commonIndex(U4,D4)) == 20);
+        CHECK(spec4.truncerr() == spec1.truncerr());
+        CHECK(norm(U4*D4*V4-U1*D1*V1) < 1E-12);
+        }
+
+    SECTION("SVDMethod")
+        {
+        auto u = Index(QN(+1),10,QN(0),20,QN(-1),8,"u");
+        auto v = Index(QN(+1),12,QN(0),15,QN(-1),9,"v");
+        auto S = randomITensorC(QN(),u,v);
+        auto args = Args("MaxDim",20);
+        ITensor U1(u),D1,V1;
+        auto spec1 = svd(S,U1,D1,V1,args);
+        for(auto method : {"gesdd","gesvd"})
+            {
+            ITensor U2(u),D2,V2;
+            auto spec2 = svd(S,U2,D2,V2,{args,"SVDMethod",method});
+            CHECK(dim(commonIndex(U2,D2)) == 20);
+            CHECK(std::fabs(spec2.truncerr()-spec1.truncerr()) < 1E-12);
+            CHECK(norm(U2*D2*V2-U1*D1*V1) < 1E-10);
+            }
+        }
+
+    SECTION("Randomized")
+        {
+        auto u = Index(QN(+2),60,QN(0),80,QN(-2),50,"u");
+        auto v = Index(QN(+2),70,QN(0),60,QN(-2),40,"v");
+        auto S = randomITensor(QN(),u,v);
+        //Make the singular values decay quickly
+        ITensor U(u),D,V;
+        svd(S,U,D,V);
+        D.apply([](Real x) { return std::pow(x,4); });
+        S = U*D*V;
+        S /= norm(S);
+        auto args = Args("MaxDim",8,"Cutoff",1E-16);
+
+        ITensor U1(u),D1,V1;
+        resetOpCounts();
+        auto spec1 = svd(S,U1,D1,V1,args);
+        auto full_flops = opCounts().flops;
+
+        ITensor U2(u),D2,V2;
+        resetOpCounts();
+        auto spec2 = svd(S,U2,D2,V2,{args,"RandomSVD",true});
+        auto rand_flops = opCounts().flops;
+
+        CHECK(rand_flops < full_flops/2);
+        CHECK(dim(commonIndex(U2,D2)) == 8);
+        //Error is close to that of the optimal truncation
+        auto err1 = sqr(norm(S-U1*D1*V1)),
+             err2 = sqr(norm(S-U2*D2*V2));
+        CHECK(err2 < (1+1E-3)*err1);
+        CHECK(std::fabs(spec2.truncerr()-spec1.truncerr()) < 1E-3*spec1.truncerr());
+        }
+
+    SECTION("Randomized, Rank Growth and Fallback")
+        {
+        auto u = Index(QN(+1),40,QN(-1),40,"u");
+        auto v = Index(QN(+1),50,QN(-1),50,"v");
+        auto S = randomITensor(QN(),u,v);
+        ITensor U(u),D,V;
+        svd(S,U,D,V);
+        D.apply([](Real x) { return std::pow(x,12); });
+        S = U*D*V;
+        S /= norm(S);
+
+        //Cutoff decides the dimension: rank
+        //grows from 2 until the cutoff is met
+        auto args = Args("MaxDim",100,"Cutoff",1E-10);
+        ITensor U1(u),D1,V1;
+        svd(S,U1,D1,V1,args);
+        ITensor U2(u),D2,V2;
+        svd(S,U2,D2,V2,{args,"RandomSVD",true,"RankGuess",2});
+        CHECK(dim(commonIndex(U2,D2)) == dim(commonIndex(U1,D1)));
+        CHECK(sqr(norm(S-U2*D2*V2)) < 1E-10);
+
+        //Flat spectrum: falls back to the full SVD
+        auto R = randomITensor(QN(),u,v);
+        auto rargs = Args("MaxDim",10);
+        ITensor U3(u),D3,V3;
+        auto spec3 = svd(R,U3,D3,V3,rargs);
+        ITensor U4(u),D4,V4;
+        auto spec4 = svd(R,U4,D4,V4,{rargs,"RandomSVD",true});
+        CHECK(spec4.truncerr() == spec3.truncerr());
+        CHECK(norm(U4*D4*V4-U3*D3*V3) < 1E-12);
+        }
+
     }
 
 SECTION("QN ITensor denmatDecomp")
@@ -362,6 +490,25 @@ SECTION("ITensor diagHermitian (with QNs)")
         CHECK(hasIndex(U,prime(I)));
         CHECK(norm(T-dag(U)*D*prime(U,3)) < 1E-12);
         }
+
+    SECTION("Blocks in Parallel")
+        {
+        auto I = Index(QN(-1),12,QN(0),3,QN(+1),25,"I");
+        auto T = randomITensorC(QN(),dag(I),prime(I));
+        T += dag(swapTags(T,"0","1"));
+
+        ITensor U1,D1;
+        diagHermitian(T,U1,D1);
+
+        auto nthread = Args::global().getInt("NThread",1);
+        Args::global().add("NThread",4);
+        ITensor U4,D4;
+        diagHermitian(T,U4,D4);
+        Args::global().add("NThread",nthread);
+
+        CHECK(norm(T-dag(U4)*D4*prime(U4)) < 1E-12);
+        CHECK(norm(dag(U4)*D4*prime(U4)-dag(U1)*D1*prime(U1)) < 1E-12);
+        }
     }
 
 SECTION("Truncating (Special Cases)")
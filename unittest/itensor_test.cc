@@ -1,5 +1,7 @@
 #include "test.h"
 #include "itensor/itensor.h"
+#include "itensor/itdata/qutil.h"
+#include "itensor/contractnetwork.h"
 #include "itensor/util/cplx_literal.h"
 #include "itensor/util/iterate.h"
 #include "itensor/util/set_scoped.h"
@@ -1366,6 +1368,55 @@ SECTION("Complex Times Scalar Complex")
     }
 }
 
+SECTION("Threaded QN Contraction")
+    {
+    auto T1 = randomITensor(QN(),L1,S1,S2,prime(L2)),
+         T2 = randomITensor(QN(),dag(prime(L2)),dag(S2),S3,L2);
+    auto R = T1*T2;
+    auto args_save = Args::global();
+    Args::global().add("NThread",3);
+    auto Rt = T1*T2;
+    Args::global() = args_save;
+    CHECK(hasQNs(Rt));
+    CHECK(norm(R) > 1E-10);
+    CHECK(norm(R-Rt) < 1E-12);
+    }
+
+SECTION("Cached QN Block Contraction Plans")
+    {
+    auto& cache = blockPlanCache();
+    cache.clear();
+    auto T1 = randomITensor(QN(),L1,S1,S2,prime(L2)),
+         T2 = randomITensor(QN(),dag(prime(L2)),dag(S2),S3,L2);
+    auto hits = cache.hits();
+    auto R1 = T1*T2;
+    CHECK(cache.size() == 1);
+    CHECK(cache.hits() == hits);
+    //Same block structure, different data
+    auto U1 = randomITensor(QN(),L1,S1,S2,prime(L2));
+    auto R2 = U1*T2;
+    CHECK(cache.size() == 1);
+    CHECK(cache.hits() == hits+1);
+    for(auto l1 : range1(dim(L1)))
+    for(auto s1 : range1(dim(S1)))
+    for(auto s3 : range1(dim(S3)))
+    for(auto l2 : range1(dim(L2)))
+        {
+        auto val = 0.;
+        for(auto l2p : range1(dim(L2)))
+        for(auto s2 : range1(dim(S2)))
+            {
+            val += elt(U1,L1(l1),S1(s1),S2(s2),prime(L2)(l2p))*elt(T2,prime(L2)(l2p),S2(s2),S3(s3),L2(l2));
+            }
+        CHECK_CLOSE(elt(R2,L1(l1),S1(s1),S3(s3),L2(l2)),val);
+        }
+    //A different divergence changes which blocks are present
+    auto V1 = randomITensor(QN(2),L1,S1,S2,prime(L2));
+    auto R3 = V1*T2;
+    CHECK(cache.size() == 2);
+    CHECK(norm(R3) > 1E-10);
+    }
+
 
 SECTION("Prime Level Functions")
 {
@@ -2478,6 +2529,95 @@ SECTION("ITensor Negation")
         }
     }
 
+SECTION("Contraction Sequence")
+    {
+    auto i = Index(10,"i");
+    auto j = Index(10,"j");
+    auto k = Index(10,"k");
+    auto M1 = randomITensor(i,j);
+    auto M2 = randomITensor(j,k);
+    auto v = randomITensor(k);
+
+    //Matrix-vector products first: 100+100 multiply-adds
+    //instead of 1000+100 going left to right
+    auto seq = contractionSequence({M1,M2,v});
+    CHECK(seq.steps.size() == 2);
+    CHECK_CLOSE(seq.flops,200.);
+    CHECK_CLOSE(seq.peakMemory,220.);
+    auto R = contractNetwork({M1,M2,v},seq);
+    CHECK(norm(R-M1*M2*v) < 1E-10*norm(R));
+
+    auto gseq = contractionSequence({M1,M2,v},{"MaxExhaustive",1});
+    CHECK_CLOSE(gseq.flops,200.);
+    R = contractNetwork({M1,M2,v},gseq);
+    CHECK(norm(R-M1*M2*v) < 1E-10*norm(R));
+
+    //Larger network: a ring of matrices with
+    //one open index each (uses the greedy order)
+    auto N = 10;
+    auto b = std::vector<Index>(N);
+    auto s = std::vector<Index>(N);
+    for(auto n : range(N))
+        {
+        b[n] = Index(3,"b");
+        s[n] = Index(2,"s");
+        }
+    auto T = std::vector<ITensor>(N);
+    for(auto n : range(N)) T[n] = randomITensor(b[n],s[n],b[(n+1)%N]);
+    auto ref = T[0];
+    for(auto n : range(1,N)) ref *= T[n];
+    R = contractNetwork(T);
+    CHECK(hasSameInds(R.inds(),ref.inds()));
+    CHECK(norm(R-ref) < 1E-10*norm(ref));
+
+    CHECK(contractionSequence(T,{"MaxExhaustive",N}).flops <= contractionSequence(T).flops);
+
+    //Larger values of MaxExhaustive than MAX_EXHAUSTIVE
+    //fall back to the greedy order for longer rings
+    auto N2 = 2*MAX_EXHAUSTIVE;
+    auto b2 = std::vector<Index>(N2);
+    for(auto& i : b2) i = Index(3,"b");
+    auto T2 = std::vector<ITensor>(N2);
+    for(auto n : range(N2)) T2[n] = randomITensor(b2[n],Index(2,"s"),b2[(n+1)%N2]);
+    CHECK_CLOSE(contractionSequence(T2,{"MaxExhaustive",100}).flops,contractionSequence(T2).flops);
+    }
+
+SECTION("Operation Counts")
+    {
+    auto i = Index(10,"i");
+    auto j = Index(20,"j");
+    auto k = Index(30,"k");
+    auto A = randomITensor(i,j);
+    auto B = randomITensor(j,k);
+
+    resetOpCounts();
+    auto c0 = opCounts();
+    CHECK(c0.flops == 0);
+    CHECK(c0.peak_bytes == c0.live_bytes);
+        {
+        auto C = A*B;
+        auto c1 = opCounts();
+        CHECK(c1.ncontract == 1);
+        CHECK(c1.ngemm == 1);
+        CHECK_CLOSE(c1.flops,2*10*20*30);
+        CHECK(c1.nalloc >= 1);
+        CHECK(c1.live_bytes-c0.live_bytes >= 10*30*sizeof(Real));
+        CHECK(c1.peak_bytes >= c1.live_bytes);
+        }
+    //Storage of C freed
+    CHECK(opCounts().live_bytes < c0.live_bytes+10*30*sizeof(Real));
+
+    //Block-sparse contractions are counted too
+    auto s = Index(QN(-1),2,QN(+1),2,"s");
+    auto l = Index(QN(0),3,QN(1),3,"l");
+    auto Q1 = randomITensor(QN(),s,l);
+    auto Q2 = randomITensor(QN(),dag(l),prime(s));
+    resetOpCounts();
+    auto Q = Q1*Q2;
+    CHECK(opCounts().ncontract == 1);
+    CHECK(opCounts().flops > 0);
+    }
+
 
 } //TEST_CASE("ITensor")
 
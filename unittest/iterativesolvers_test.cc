@@ -3,6 +3,7 @@
 #include "sample/Heisenberg.h"
 #include "itensor/mps/sites/spinhalf.h"
 #include "itensor/mps/localmpo.h"
+#include "itensor/mps/dmrg.h"
 
 using namespace itensor;
 using namespace std;
@@ -27,7 +28,7 @@ class ITensorMap
         b.replaceTags("1","0");
         }
 
-    long
+    size_t
     size() const
         {
         if(size_ == -1)
@@ -44,6 +45,32 @@ class ITensorMap
 
     };
 
+//ITensorMap with a diagonal, counting products
+class DiagITensorMap : public ITensorMap
+    {
+    ITensor diag_;
+    mutable int nproduct_ = 0;
+    public:
+
+    DiagITensorMap(ITensor const& A, ITensor const& D)
+      : ITensorMap(A),
+        diag_(D)
+        { }
+
+    void
+    product(ITensor const& x, ITensor& b) const
+        {
+        ++nproduct_;
+        ITensorMap::product(x,b);
+        }
+
+    ITensor
+    diag() const { return diag_; }
+
+    int
+    nproduct() const { return nproduct_; }
+    };
+
 TEST_CASE("EigenSolverTest")
 {
 
@@ -172,6 +199,135 @@ SECTION("IQFourSite")
 
     }
 
+SECTION("Block Davidson")
+    {
+    auto a1 = Index(4,"Site,a1");
+    auto a2 = Index(5,"Site,a2");
+    auto A = randomITensor(prime(a1),prime(a2),a1,a2);
+    A += swapInds(A,{prime(a1),prime(a2)},{a1,a2});
+
+    //Exact eigenvalues, in increasing order
+    auto [U,D] = diagHermitian(-A);
+    auto exact = std::vector<Real>{};
+    for(auto n : range1(dim(commonIndex(U,D)))) exact.push_back(-elt(D,n,n));
+
+    auto nget = 3;
+    auto guess = [&]()
+        {
+        auto phi = std::vector<ITensor>(nget);
+        for(auto& T : phi) T = randomITensor(a1,a2);
+        return phi;
+        };
+
+    auto phi = guess();
+    auto eigs = blockDavidson(ITensorMap(A),phi,{"MaxIter",20,"ErrGoal",1E-12});
+    for(auto j : range(nget))
+        {
+        CHECK_CLOSE(eigs[j],exact[j]);
+        auto Aphi = (A*phi[j]).noPrime();
+        CHECK(norm(Aphi-eigs[j]*phi[j]) < 1E-5);
+        }
+
+    //Thick restart keeping the subspace at most 8 vectors
+    phi = guess();
+    eigs = blockDavidson(ITensorMap(A),phi,{"MaxIter",100,"MaxSubspace",8,"ErrGoal",1E-12});
+    for(auto j : range(nget)) CHECK_CLOSE(eigs[j],exact[j]);
+    }
+
+SECTION("Block Davidson LocalMPO")
+    {
+    const int N = 8;
+    auto sweeps = Sweeps(2);
+    sweeps.maxdim() = 8;
+
+    //Block product of QN tensors agrees with the single products
+    auto qsites = SpinHalf(N);
+    MPO qH = Heisenberg(qsites);
+    auto state = InitState(qsites);
+    for(auto j : range1(N)) state.set(j,j%2==1 ? "Up" : "Dn");
+    auto [qE0,qpsi] = dmrg(qH,MPS(state),sweeps,{"Silent",true});
+    LocalMPO qPH(qH);
+    qpsi.position(4);
+    qPH.position(4,qpsi);
+    auto qphi = std::vector<ITensor>{qpsi(4)*qpsi(5),qpsi(4)*qpsi(5),qpsi(4)*qpsi(5)};
+    for(auto& T : qphi) T.randomize();
+    auto qHphi = std::vector<ITensor>{};
+    qPH.product(qphi,qHphi);
+    for(auto j : range(qphi))
+        {
+        ITensor Hphi_j;
+        qPH.product(qphi[j],Hphi_j);
+        CHECK(norm(qHphi[j]-Hphi_j) < 1E-12*norm(Hphi_j));
+        }
+
+    //Lowest eigenvalues of the effective Hamiltonian
+    auto sites = SpinHalf(N,{"ConserveQNs=",false});
+    MPO H = Heisenberg(sites);
+    auto [E0,psi] = dmrg(H,randomMPS(sites),sweeps,{"Silent",true});
+    LocalMPO PH(H);
+    psi.position(4);
+    PH.position(4,psi);
+    auto Heff = PH.L()*H(4)*H(5)*PH.R();
+    auto [U,D] = diagHermitian(-Heff);
+    auto phi = std::vector<ITensor>{psi(4)*psi(5),randomITensor(inds(psi(4)*psi(5)))};
+    auto eigs = blockDavidson(PH,phi,{"MaxIter",30,"MaxSubspace",6,"ErrGoal",1E-12});
+    CHECK_CLOSE(eigs[0],-elt(D,1,1));
+    CHECK_CLOSE(eigs[1],-elt(D,2,2));
+    }
+
+SECTION("Davidson Ritz Vector")
+    {
+    //Stopped before converging, davidson still
+    //returns the Ritz vector of its eigenvalue
+    auto a = Index(40,"a");
+    auto B = randomITensor(prime(a),a);
+    auto A = B + swapInds(B,{prime(a)},{a});
+    auto phi = randomITensor(a);
+    auto AM = ITensorMap(A);
+    auto lambda = davidson(AM,phi,{"MaxIter",4,"ErrGoal",1E-14});
+    auto Aphi = noPrime(A*phi);
+    CHECK_CLOSE(elt(phi*Aphi)/elt(phi*phi),lambda);
+    }
+
+SECTION("Davidson Preconditioner")
+    {
+    //Diagonally dominant matrix
+    auto a = Index(60,"a");
+    auto B = 0.05*randomITensor(prime(a),a);
+    auto A = B + swapInds(B,{prime(a)},{a});
+    auto D = ITensor(a);
+    for(auto i : range1(dim(a)))
+        {
+        A.set(prime(a)=i,a=i,elt(A,prime(a)=i,a=i)+i);
+        D.set(a=i,elt(A,prime(a)=i,a=i));
+        }
+    auto [U,DA] = diagHermitian(-A);
+    auto exact = -elt(DA,1,1);
+
+    auto args = Args{"MaxIter",59,"ErrGoal",1E-10};
+    auto phi1 = randomITensor(a);
+    phi1 /= norm(phi1);
+    auto phi2 = phi1;
+    auto A1 = DiagITensorMap(A,D);
+    auto E1 = davidson(A1,phi1,args);
+    auto A2 = DiagITensorMap(A,D);
+    auto E2 = davidson(A2,phi2,{args,"Precondition",true});
+    CHECK_CLOSE(E1,exact);
+    CHECK_CLOSE(E2,exact);
+    CHECK(A2.nproduct() < A1.nproduct());
+
+    auto phi3 = std::vector<ITensor>{phi2,phi2};
+    for(auto& T : phi3)
+        {
+        T.randomize();
+        T /= norm(T);
+        }
+    auto A3 = DiagITensorMap(A,D);
+    auto E3 = blockDavidson(A3,phi3,{"MaxIter",40,"ErrGoal",1E-10,"Precondition",true});
+    CHECK_CLOSE(E3[0],exact);
+    CHECK_CLOSE(E3[1],-elt(DA,2,2));
+    }
+
 SECTION("GMRES (ITensor, Real)")
     {
     auto a1 = Index(3,"Site,a1");
@@ -227,4 +383,21 @@ SECTION("GMRES (ITensor, QN)")
 
     }
 
+SECTION("applyExp")
+    {
+    auto a = Index(40,"a");
+    auto B = randomITensor(prime(a),a);
+    auto A = B + swapInds(B,{prime(a)},{a});
+    auto phi = randomITensor(a);
+    for(auto t : {Cplx(0,-0.5),Cplx(-0.2,0)})
+        {
+        auto x = phi;
+        auto E = applyExp(ITensorMap(A),x,t,{"MaxIter",40,"ErrGoal",1E-12});
+        CHECK_CLOSE(E,elt(phi*noPrime(A*phi))/elt(phi*phi));
+        auto check = noPrime(expHermitian(A,t)*phi);
+        CHECK(norm(x-check) < 1E-10*norm(check));
+        CHECK(isComplex(x) == (t.imag() != 0.));
+        }
+    }
+
 }
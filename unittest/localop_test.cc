@@ -1,6 +1,8 @@
 #include "test.h"
 #include "itensor/mps/localop.h"
 #include "itensor/mps/localmpo.h"
+#include "itensor/mps/dmrg.h"
+#include "itensor/mps/autompo.h"
 #include "itensor/mps/sites/spinhalf.h"
 #include "itensor/util/print_macro.h"
 
@@ -61,6 +63,69 @@ SECTION("Product")
         CHECK(hasIndex(Hpsi,l0));
         CHECK(hasIndex(Hpsi,l2));
         }
+
+    SECTION("Matches Direct Contraction")
+        {
+        auto Op1 = randomITensor(h0,s1,prime(s1),h1);
+        auto Op2 = randomITensor(prime(s2),h1,s2,h2);
+        auto L = randomITensor(h0,l0,prime(l0));
+        auto R = randomITensor(l2,h2,prime(l2));
+        auto lop = LocalOp(Op1,Op2,L,R);
+        auto psi = randomITensor(s1,l0,l2,s2);
+        auto Hpsi = ITensor();
+        for(auto pass : range(2))
+            {
+            lop.product(psi,Hpsi);
+            auto check = noPrime(psi*L*Op1*Op2*R);
+            CHECK(norm(Hpsi-check) < 1E-10*norm(check));
+            //Result has the same index order as psi
+            for(auto j : range1(order(psi)))
+                {
+                CHECK(index(Hpsi,j) == index(psi,j));
+                }
+            psi = randomITensor(s1,l0,l2,s2);
+            if(pass == 0) psi *= 2.;
+            }
+        }
+
+    SECTION("Matches Direct Contraction - QNs")
+        {
+        auto Op1 = randomITensor(QN(),H0,S1,prime(dag(S1)),dag(H1));
+        auto Op2 = randomITensor(QN(),prime(dag(S2)),H1,S2,dag(H2));
+        auto L = randomITensor(QN(),dag(H0),L0,prime(dag(L0)));
+        auto R = randomITensor(QN(),dag(L2),H2,prime(L2));
+        auto lop = LocalOp(Op1,Op2,L,R);
+        auto psi = randomITensor(QN(),dag(S1),dag(L0),L2,dag(S2));
+        auto Hpsi = ITensor();
+        lop.product(psi,Hpsi);
+        auto check = noPrime(psi*L*Op1*Op2*R);
+        CHECK(norm(check) > 1E-10);
+        CHECK(norm(Hpsi-check) < 1E-10*norm(check));
+        }
+
+    SECTION("Block Product - Varying Sizes")
+        {
+        auto Op1 = randomITensor(QN(),H0,S1,prime(dag(S1)),dag(H1));
+        auto Op2 = randomITensor(QN(),prime(dag(S2)),H1,S2,dag(H2));
+        auto L = randomITensor(QN(),L0,dag(H0),prime(dag(L0)));
+        auto R = randomITensor(QN(),dag(L2),H2,prime(L2));
+        auto lop = LocalOp(Op1,Op2,L,R);
+        //Alternate block sizes and single products,
+        //each of which reuses its own plan
+        for(auto nb : {2,3,1,2,3})
+            {
+            auto phi = std::vector<ITensor>(nb);
+            for(auto& p : phi) p = randomITensor(QN(),dag(S1),dag(L0),L2,dag(S2));
+            auto phip = std::vector<ITensor>{};
+            lop.product(phi,phip);
+            REQUIRE(phip.size() == size_t(nb));
+            for(auto n : range(nb))
+                {
+                auto check = noPrime(phi[n]*L*Op1*Op2*R);
+                CHECK(norm(phip[n]-check) < 1E-10*norm(check));
+                }
+            }
+        }
     }
 
 SECTION("Diag")
@@ -79,18 +144,33 @@ SECTION("Diag")
         CHECK(hasIndex(diag,l2));
         }
 
-    //SECTION("Bulk Case - IQTensor")
-    //    {
-    //    auto Op1 = randomITensor(QN(),S1,prime(S1),H0,H1);
-    //    auto Op2 = randomITensor(QN(),S2,prime(S2),H1,H2);
-    //    auto L = randomITensor(QN(),L0,prime(L0),H0);
-    //    auto R = randomITensor(QN(),L2,prime(L2),H2);
-    //    auto diag = lop.diag();
-    //    CHECK(hasIndex(diag,S1));
-    //    CHECK(hasIndex(diag,S2));
-    //    CHECK(hasIndex(diag,L0));
-    //    CHECK(hasIndex(diag,L2));
-    //    }
+    SECTION("Bulk Case - QNs")
+        {
+        auto Op1 = randomITensor(QN(),H0,S1,prime(dag(S1)),dag(H1));
+        auto Op2 = randomITensor(QN(),prime(dag(S2)),H1,S2,dag(H2));
+        auto L = randomITensor(QN(),dag(H0),L0,prime(dag(L0)));
+        auto R = randomITensor(QN(),dag(L2),H2,prime(L2));
+        auto lop = LocalOp(Op1,Op2,L,R);
+        auto diag = lop.diag();
+        CHECK(!hasQNs(diag));
+
+        //Matches the diagonal of the dense matrix
+        auto psi = randomITensor(QN(),dag(S1),dag(L0),L2,dag(S2));
+        auto [C,c] = combiner(inds(removeQNs(psi)));
+        auto M = C*removeQNs(L*Op1*Op2*R)*prime(C);
+        auto diagc = diag*C;
+        for(auto i : range1(dim(c)))
+            {
+            CHECK_CLOSE(elt(diagc,c=i),elt(M,c=i,prime(c)=i));
+            }
+
+        //Multiplies QN tensors elementwise, keeping their blocks
+        auto dpsi = psi;
+        dpsi /= diag;
+        CHECK(hasQNs(dpsi));
+        auto check = removeQNs(psi)/diag;
+        CHECK(norm(removeQNs(dpsi)-check) < 1E-12*norm(check));
+        }
     }
 }
 
@@ -115,6 +195,73 @@ SECTION("LocalMPO As MPS")
     auto lmps = LocalMPO(psiN);
     lmps.position(3,psiF);
     }
+
+SECTION("DiskCache")
+    {
+    auto dir = mkTempDir("DiskCacheTest","/tmp");
+    auto i = Index(3),
+         j = Index(4);
+    auto A = randomITensor(i,j),
+         B = randomITensor(i,prime(i));
+    auto fA = dir + "/A",
+         fB = dir + "/B";
+
+    auto disk = DiskCache(0);
+    disk.write(fA,A);
+    disk.write(fB,B);
+    disk.flush();
+    CHECK(disk.stats().nwrite == 2);
+
+    //With no memory budget, reads come from the files
+    CHECK(norm(disk.read(fA)-A) < 1E-14);
+    CHECK(disk.stats().nhit == 0);
+
+    //A prefetched tensor is kept until read
+    disk.prefetch(fB);
+    CHECK(norm(disk.read(fB)-B) < 1E-14);
+    auto st = disk.stats();
+    CHECK(st.nread == 2);
+    CHECK(st.nhit+st.nwait == 1);
+
+    //Writing again replaces what is read back
+    auto A2 = 2*A;
+    disk.write(fA,A2);
+    CHECK(norm(disk.read(fA)-A2) < 1E-14);
+
+    CHECK_THROWS_AS(disk.read(dir+"/none"),ITError);
+    }
+
+SECTION("DMRG Write to Disk")
+    {
+    auto N = 16;
+    auto sites = SpinHalf(N);
+    auto ampo = AutoMPO(sites);
+    for(auto j : range1(N-1))
+        {
+        ampo += 0.5,"S+",j,"S-",j+1;
+        ampo += 0.5,"S-",j,"S+",j+1;
+        ampo +=     "Sz",j,"Sz",j+1;
+        }
+    auto H = toMPO(ampo);
+    auto state = InitState(sites);
+    for(auto j : range1(N)) state.set(j,j%2==1 ? "Up" : "Dn");
+    auto psi0 = MPS(state);
+
+    auto sweeps = Sweeps(4);
+    sweeps.maxdim() = 10,20,40;
+    sweeps.cutoff() = 1E-10;
+    auto [E1,psi1] = dmrg(H,psi0,sweeps,{"Silent",true});
+    (void)psi1;
+    for(auto cache_mb : {0.,10.})
+        {
+        auto [E2,psi2] = dmrg(H,psi0,sweeps,{"Silent",true,
+                                            "WriteDim",1,
+                                            "WriteDir","/tmp",
+                                            "WriteCacheMB",cache_mb});
+        (void)psi2;
+        CHECK_CLOSE(E1,E2);
+        }
+    }
 }
 
 
@@ -3,6 +3,7 @@
 #include "itensor/util/autovector.h"
 #include "itensor/util/iterate.h"
 #include "itensor/tensor/algs.h"
+#include "itensor/tensor/gemmbatch.h"
 #include "itensor/global.h"
 
 using namespace itensor;
@@ -1014,6 +1015,137 @@ SECTION("Test Matrix multiplication")
         }
     }
 
+SECTION("Complex and Mixed gemm")
+    {
+    auto Ar = 3,
+         K  = 4,
+         Bc = 5;
+    auto alpha = 0.7,
+         beta = -1.3;
+    auto rA = Matrix(Ar,K),
+         rAt = Matrix(K,Ar),
+         rB = Matrix(K,Bc),
+         rBt = Matrix(Bc,K);
+    auto cA = CMatrix(Ar,K),
+         cAt = CMatrix(K,Ar),
+         cB = CMatrix(K,Bc),
+         cBt = CMatrix(Bc,K);
+    for(auto* M : {&rA,&rAt,&rB,&rBt})
+        for(auto& el : *M) el = detail::quickran();
+    for(auto* M : {&cA,&cAt,&cB,&cBt})
+        for(auto& el : *M) el = Cplx(detail::quickran(),detail::quickran());
+
+    //Check C = alpha*A*B+beta*C0 for every combination of
+    //real/complex and transposed/untransposed A, B and C
+    auto check = [&](auto A, auto B, bool transC)
+        {
+        auto C0 = CMatrix(Ar,Bc);
+        for(auto& el : C0) el = Cplx(detail::quickran(),detail::quickran());
+        auto Ct = CMatrix(Bc,Ar);
+        for(auto r : range(Ar))
+        for(auto c : range(Bc))
+            {
+            Ct(c,r) = C0(r,c);
+            }
+        if(transC) gemm(A,B,transpose(makeRef(Ct)),alpha,beta);
+        else       gemm(A,B,makeRef(C0),alpha,beta);
+        for(auto r : range(Ar))
+        for(auto c : range(Bc))
+            {
+            Cplx val = 0;
+            for(auto k : range(K)) val += Cplx(A(r,k))*Cplx(B(k,c));
+            auto C = transC ? Ct(c,r) : C0(r,c);
+            auto expected = alpha*val + beta*(transC ? C0(r,c) : Ct(c,r));
+            CHECK_CLOSE(C,expected);
+            }
+        };
+    for(auto transC : {false,true})
+        {
+        check(makeRef(cA),makeRef(rB),transC);
+        check(makeRef(cA),transpose(makeRef(rBt)),transC);
+        check(transpose(makeRef(cAt)),makeRef(rB),transC);
+        check(makeRef(rA),makeRef(cB),transC);
+        check(transpose(makeRef(rAt)),transpose(makeRef(cBt)),transC);
+        check(makeRef(cA),makeRef(cB),transC);
+        check(transpose(makeRef(cAt)),transpose(makeRef(cBt)),transC);
+        }
+    }
+
+SECTION("Batched gemm")
+    {
+    auto alpha = 0.7,
+         beta = -1.3;
+    //Check C[i] = alpha*A[i]*B[i]+beta*C0[i] for a batch
+    //of three products stored as column-major arrays
+    auto check = [alpha,beta](GemmShape const& s, auto a0, auto b0)
+        {
+        using VA = decltype(a0);
+        using VB = decltype(b0);
+        using VC = decltype(a0*b0);
+        struct Ran
+            {
+            void
+            operator()(Real& x) const { x = detail::quickran(); }
+            void
+            operator()(Cplx& z) const { z = Cplx(detail::quickran(),detail::quickran()); }
+            };
+        auto ran = [](auto& v)
+            {
+            for(auto& el : v) Ran{}(el);
+            };
+        auto count = 3l;
+        auto A = std::vector<std::vector<VA>>(count,std::vector<VA>(s.m*s.k));
+        auto B = std::vector<std::vector<VB>>(count,std::vector<VB>(s.k*s.n));
+        auto C = std::vector<std::vector<VC>>(count,std::vector<VC>(s.m*s.n));
+        auto pa = std::vector<VA const*>{};
+        auto pb = std::vector<VB const*>{};
+        auto pc = std::vector<VC *>{};
+        for(auto i : range(count))
+            {
+            ran(A[i]);
+            ran(B[i]);
+            ran(C[i]);
+            pa.push_back(A[i].data());
+            pb.push_back(B[i].data());
+            pc.push_back(C[i].data());
+            }
+        auto C0 = C;
+        gemmBatch(s,pa.data(),pb.data(),pc.data(),count,alpha,beta);
+        for(auto i : range(count))
+        for(auto r : range(s.m))
+        for(auto c : range(s.n))
+            {
+            VC val = 0;
+            for(auto l : range(s.k))
+                {
+                auto a = s.transA ? A[i][l+r*s.k] : A[i][r+l*s.m];
+                auto b = s.transB ? B[i][c+l*s.n] : B[i][l+c*s.k];
+                val += a*b;
+                }
+            CHECK_CLOSE(C[i][r+c*s.m],alpha*val+beta*C0[i][r+c*s.m]);
+            }
+        };
+    for(auto dims : {std::vector<long>{3,5,4},
+                     std::vector<long>{1,7,2},
+                     std::vector<long>{12,3,9},
+                     std::vector<long>{40,6,35}})
+    for(auto transA : {false,true})
+    for(auto transB : {false,true})
+        {
+        auto s = GemmShape{};
+        s.m = dims[0];
+        s.n = dims[1];
+        s.k = dims[2];
+        s.transA = transA;
+        s.transB = transB;
+        CHECK(isSmallGemm(s) == (s.m <= 32));
+        check(s,Real(0),Real(0));
+        check(s,Cplx(0),Real(0));
+        check(s,Real(0),Cplx(0));
+        check(s,Cplx(0),Cplx(0));
+        }
+    }
+
 
 SECTION("Addition / Subtraction")
     {
@@ -1567,6 +1699,96 @@ SECTION("Singular Value Decomp")
 
         CHECK(norm(M-U*D*conj(transpose(V))) < 1E-12);
         }
+
+    SECTION("LAPACK SVD")
+        {
+        for(auto method : {SVDGesdd,SVDGesvd})
+        for(auto shape : {std::make_pair(30,20),std::make_pair(20,30),std::make_pair(25,25)})
+            {
+            auto M = randomMat(shape.first,shape.second);
+            Matrix U,V,U0,V0;
+            Vector d,d0;
+            SVD(M,U,d,V,method);
+            SVD(M,U0,d0,V0);
+            auto ns = std::min(shape.first,shape.second);
+            CHECK(d.size() == ns);
+            CHECK(norm(d-d0) < 1E-12);
+            auto D = Matrix(ns,ns);
+            diagonal(D) &= d;
+            CHECK(norm(M-U*D*transpose(V)) < 1E-12);
+            }
+
+        auto M = CMatrix(15,12);
+        for(auto& el : M) el = Global::random() + 1_i*Global::random();
+        CMatrix U,V;
+        Vector d;
+        SVD(M,U,d,V,SVDGesdd);
+        auto D = Matrix(d.size(),d.size());
+        diagonal(D) &= d;
+        CHECK(norm(M-U*D*conj(transpose(V))) < 1E-12);
+        SVD(M,U,d,V,SVDGesvd);
+        diagonal(D) &= d;
+        CHECK(norm(M-U*D*conj(transpose(V))) < 1E-12);
+        }
+
+    SECTION("Randomized SVD")
+        {
+        auto nr = 80,
+             nc = 60;
+        auto M = randomMat(nr,nc);
+        Matrix U,V;
+        Vector d;
+        SVD(M,U,d,V);
+        for(auto j : range(d)) d(j) = pow(0.7,j);
+        auto DD = Matrix(d.size(),d.size());
+        diagonal(DD) &= d;
+        M = U*DD*transpose(V);
+
+        auto nsv = 20;
+        Real exact_tail = 0;
+        for(auto j : range(nsv,d.size())) exact_tail += sqr(d(j));
+
+        Matrix RU,RV;
+        Vector rd;
+        auto tail = randomSVD(M,RU,rd,RV,nsv);
+        CHECK(rd.size() == nsv);
+        //Range found can only miss more weight than the optimum
+        CHECK(tail > (1-1E-8)*exact_tail);
+        CHECK(tail < 2*exact_tail);
+        for(auto j : range(10)) CHECK(std::fabs(rd(j)-d(j)) < 1E-10);
+        auto RD = Matrix(nsv,nsv);
+        diagonal(RD) &= rd;
+        CHECK(std::fabs(sqr(norm(M-RU*RD*transpose(RV)))-tail) < 1E-8*tail);
+        auto Id = Matrix(nsv,nsv);
+        for(auto j : range(nsv)) Id(j,j) = 1;
+        CHECK(norm(transpose(RU)*RU-Id) < 1E-12);
+        CHECK(norm(transpose(RV)*RV-Id) < 1E-12);
+
+        //Asking for all singular values does the full SVD
+        CHECK(randomSVD(M,RU,rd,RV,nc) == 0.);
+        CHECK(rd.size() == nc);
+        }
+
+    SECTION("Complex Randomized SVD")
+        {
+        auto n = 50;
+        auto M = CMatrix(n,n);
+        for(auto& el : M) el = Global::random() + 1_i*Global::random();
+        CMatrix U,V;
+        Vector d;
+        SVD(M,U,d,V);
+        for(auto j : range(d)) d(j) = pow(0.6,j);
+        auto DD = Matrix(n,n);
+        diagonal(DD) &= d;
+        M = U*DD*conj(transpose(V));
+
+        auto tail = randomSVD(M,U,d,V,15);
+        auto D = Matrix(d.size(),d.size());
+        diagonal(D) &= d;
+        CHECK(std::fabs(d(0)-1.) < 1E-12);
+        CHECK(std::fabs(sqr(norm(M-U*D*conj(transpose(V))))-tail) < 1E-8*tail);
+        CHECK(tail < 1E-6);
+        }
     }
 
 //SECTION("Complex SVD")
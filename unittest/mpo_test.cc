@@ -7,6 +7,7 @@
 #include "itensor/mps/sites/electron.h"
 #include "itensor/mps/autompo.h"
 #include "itensor/mps/dmrg.h"
+#include "itensor/mps/tdvp.h"
 #include "mps_mpo_test_helper.h"
 
 using namespace itensor;
@@ -403,6 +404,68 @@ SECTION("applyMPO (Fit) with custom tags")
     CHECK_CLOSE(errorMPOProd(Hpsi,H,psi),0.0);
     }
 
+SECTION("applyMPO (ZipUp)")
+    {
+    auto N = 20;
+    auto sites = SpinHalf(N);
+
+    auto ampo = AutoMPO(sites);
+    for(auto j : range1(N-1))
+        {
+        ampo += 0.5,"S+",j,"S-",j+1;
+        ampo += 0.5,"S-",j,"S+",j+1;
+        ampo += "Sz",j,"Sz",j+1;
+        }
+    auto H = toMPO(ampo);
+
+    auto kmpo = AutoMPO(sites);
+    for(auto j : range1(N-2))
+        {
+        kmpo += 0.3*j,"S+",j,"S-",j+2;
+        kmpo += 0.3*j,"S-",j,"S+",j+2;
+        kmpo += 1./j,"Sz",j;
+        }
+    auto K = toMPO(kmpo);
+
+    auto initstate = InitState(sites);
+    for(auto j : range1(N)) initstate.set(j,j%2==1 ? "Up" : "Dn");
+    auto psi = randomMPS(initstate,{"Complex=",true});
+    // Entangle psi
+    for([[maybe_unused]] auto n : range(6))
+        {
+        psi = applyMPO(H,psi,{"Cutoff=",1E-10});
+        psi.noPrime();
+        psi /= norm(psi);
+        }
+
+    auto Kpsi = applyMPO(K,psi,{"Method=","ZipUp","Cutoff=",1E-13});
+    CHECK(checkTags(Kpsi,"Site,1","Link,0"));
+    CHECK(errorMPOProd(Kpsi,K,psi) < 1E-5);
+
+    auto maxdim = 10;
+    Kpsi = applyMPO(K,psi,{"Method=","ZipUp","MaxDim=",maxdim});
+    CHECK(maxLinkDim(Kpsi) <= maxdim);
+    CHECK(errorMPOProd(Kpsi,K,psi) < 0.5);
+
+    // Zip-up is the default starting state for "Fit"
+    auto fit = applyMPO(K,psi,{"Method=","Fit","MaxDim=",maxdim,"Nsweep=",1});
+    auto dm = applyMPO(K,psi,{"Method=","DensityMatrix","MaxDim=",maxdim});
+    CHECK(maxLinkDim(fit) <= maxdim);
+    CHECK(errorMPOProd(fit,K,psi) < 1.05*errorMPOProd(dm,K,psi));
+
+    SECTION("Environments in Parallel")
+        {
+        auto nthread = Args::global().getInt("NThread",1);
+        Args::global().add("NThread",4);
+        auto dm4 = applyMPO(K,psi,{"Method=","DensityMatrix","MaxDim=",maxdim});
+        auto fit4 = applyMPO(K,psi,{"Method=","Fit","MaxDim=",maxdim,"Nsweep=",1});
+        Args::global().add("NThread",nthread);
+
+        CHECK(norm(sum(dm4,-1*dm)) < 1E-10);
+        CHECK(norm(sum(fit4,-1*fit)) < 1E-10);
+        }
+    }
+
 SECTION("Inner <Hpsi|Kphi> and <psi|H^{d}K|phi>")
     {
     detail::seed_quickran(1);
@@ -534,6 +597,42 @@ SECTION("nmultMPO (custom tags)")
   CHECK_CLOSE(traceC(A,B),traceC(C));
   }
 
+SECTION("nmultMPO (Fit)")
+  {
+  auto N = 16;
+  auto sites = SpinHalf(N);
+  auto ampo = AutoMPO(sites);
+  for(auto j : range1(N))
+  for(auto r : range1(4)) if(j+r <= N)
+    {
+    ampo += 0.5/r,"S+",j,"S-",j+r;
+    ampo += 0.5/r,"S-",j,"S+",j+r;
+    ampo += 1./r,"Sz",j,"Sz",j+r;
+    }
+  auto H = toMPO(ampo);
+  auto Hp = prime(H);
+
+  auto maxdim = 20;
+  auto args = Args{"MaxDim=",maxdim,"Fidelity=",true,"RespectDegenerate=",false};
+  MPO Cd,Cf;
+  auto fd = nmultMPO(H,Hp,Cd,{args,"Method=","DensityMatrix"});
+  auto ff = nmultMPO(H,Hp,Cf,{args,"Method=","Fit"});
+
+  CHECK(maxLinkDim(Cf) <= maxdim);
+  CHECK(checkTags(Cf,"Site,0","Site,2","Link,0"));
+  CHECK(fd > 0.9);
+  CHECK(ff <= 1+1E-12);
+  CHECK(ff > fd);
+
+  // With enough states the fit is exact
+  MPO C;
+  auto f = nmultMPO(H,Hp,C,{"Method=","Fit","MaxDim=",200,"Fidelity=",true});
+  CHECK_CLOSE(f,1.);
+  CHECK_CLOSE(traceC(C),traceC(H,Hp));
+
+  CHECK(nmultMPO(H,Hp,C,{"Method=","Fit","MaxDim=",maxdim}) == -1);
+  }
+
 SECTION("DMRG")
   {
   int N = 32;
@@ -561,4 +660,196 @@ SECTION("DMRG")
   CHECK_CLOSE(energy/N,E/(4*N));
   }
 
+SECTION("Single-site DMRG")
+  {
+  int N = 20;
+  auto sites = SpinHalf(N);
+  auto ampo = AutoMPO(sites);
+  for(int j = 1; j < N; ++j)
+      {
+      ampo += 0.5,"S+",j,"S-",j+1;
+      ampo += 0.5,"S-",j,"S+",j+1;
+      ampo +=     "Sz",j,"Sz",j+1;
+      }
+  auto H = toMPO(ampo);
+
+  auto state = InitState(sites);
+  for(auto j : range1(N)) state.set(j,j%2==1 ? "Up" : "Dn");
+  auto psi0 = MPS(state);
+
+  auto sweeps = Sweeps(5);
+  sweeps.maxdim() = 10,20,40;
+  sweeps.cutoff() = 1E-10;
+  auto [E2,psi2] = dmrg(H,psi0,sweeps,{"Silent",true});
+
+  //Single-site DMRG from the product state 
+  //relies on subspace expansion to grow the bonds
+  auto sweeps1 = Sweeps(8);
+  sweeps1.maxdim() = 10,20,40;
+  sweeps1.cutoff() = 1E-10;
+  sweeps1.noise() = 1E-3,1E-4,1E-5,1E-6,1E-7,1E-8,0;
+  auto [E1,psi1] = dmrg(H,psi0,sweeps1,{"Silent",true,"NumCenter",1});
+  CHECK(maxLinkDim(psi1) > 1);
+  CHECK(std::fabs(E1-E2) < 1E-6);
+  CHECK_CLOSE(inner(psi1,H,psi1),E1);
+  CHECK(totalQN(psi1) == totalQN(psi0));
+
+  //Continuing the two-site result with single-site sweeps
+  auto sweeps2 = Sweeps(2);
+  sweeps2.maxdim() = 40;
+  sweeps2.cutoff() = 1E-10;
+  auto [E3,psi3] = dmrg(H,psi2,sweeps2,{"Silent",true,"NumCenter",1});
+  (void)psi3;
+  CHECK(E3 < E2+1E-8);
+  }
+
+SECTION("DMRG with MaxSubspace")
+  {
+  int N = 20;
+  auto sites = SpinHalf(N);
+  auto ampo = AutoMPO(sites);
+  for(int j = 1; j < N; ++j)
+      {
+      ampo += 0.5,"S+",j,"S-",j+1;
+      ampo += 0.5,"S-",j,"S+",j+1;
+      ampo +=     "Sz",j,"Sz",j+1;
+      }
+  auto H = toMPO(ampo);
+
+  auto state = InitState(sites);
+  for(auto j : range1(N)) state.set(j,j%2==1 ? "Up" : "Dn");
+  auto psi0 = MPS(state);
+
+  auto sweeps = Sweeps(5);
+  sweeps.maxdim() = 10,20,40;
+  sweeps.cutoff() = 1E-10;
+  sweeps.niter() = 4;
+  auto [E1,psi1] = dmrg(H,psi0,sweeps,{"Silent",true});
+  //blockDavidson restarted at 3 vectors
+  auto [E2,psi2] = dmrg(H,psi0,sweeps,{"Silent",true,"MaxSubspace",3});
+  CHECK(std::fabs(E1-E2) < 1E-6);
+  CHECK_CLOSE(inner(psi2,H,psi2),E2);
+  }
+
+SECTION("DMRG with Precondition")
+  {
+  int N = 10;
+  auto sites = Electron(N);
+  auto ampo = AutoMPO(sites);
+  for(int j = 1; j < N; ++j)
+      {
+      ampo += -1,"Cdagup",j,"Cup",j+1;
+      ampo += -1,"Cdagup",j+1,"Cup",j;
+      ampo += -1,"Cdagdn",j,"Cdn",j+1;
+      ampo += -1,"Cdagdn",j+1,"Cdn",j;
+      }
+  for(int j = 1; j <= N; ++j) ampo += 8.,"Nupdn",j;
+  auto H = toMPO(ampo);
+
+  auto state = InitState(sites);
+  for(auto j : range1(N)) state.set(j,j%2==1 ? "Up" : "Dn");
+  auto psi0 = MPS(state);
+
+  auto sweeps = Sweeps(6);
+  sweeps.maxdim() = 10,20,40;
+  sweeps.cutoff() = 1E-10;
+  sweeps.niter() = 4;
+  auto obs1 = DMRGObserver(psi0,{"Silent",true});
+  auto psi1 = psi0;
+  auto E1 = dmrg(psi1,H,sweeps,obs1,{"Silent",true});
+  auto obs2 = DMRGObserver(psi0,{"Silent",true});
+  auto psi2 = psi0;
+  auto E2 = dmrg(psi2,H,sweeps,obs2,{"Silent",true,"Precondition",true});
+  CHECK(std::fabs(E1-E2) < 1E-6);
+  CHECK(obs1.sweepProducts() > 0);
+  CHECK(obs2.sweepProducts() > 0);
+  CHECK(obs1.sweepFlops() > 0);
+  CHECK(obs1.sweepTime() > 0);
+  CHECK(obs1.liveBytes() > 0);
+  }
+
+SECTION("TDVP")
+  {
+  int N = 6;
+  auto sites = SpinHalf(N,{"ConserveQNs=",false});
+  auto ampo = AutoMPO(sites);
+  for(auto i : range1(N))
+  for(auto j : range1(i+1,N))
+      {
+      //Long-range couplings
+      auto J = 1./(j-i);
+      ampo += 0.5*J,"S+",i,"S-",j;
+      ampo += 0.5*J,"S-",i,"S+",j;
+      ampo +=     J,"Sz",i,"Sz",j;
+      }
+  auto H = toMPO(ampo);
+
+  auto state = InitState(sites);
+  for(auto j : range1(N)) state.set(j,j%2==1 ? "Up" : "Dn");
+  auto psi0 = MPS(state);
+  auto E0 = inner(psi0,H,psi0);
+
+  auto full = [N](auto const& T)
+      {
+      auto F = T(1);
+      for(auto j : range1(2,N)) F *= T(j);
+      return F;
+      };
+
+  //Two-site TDVP grows the bonds from the product state
+  auto dt = 0.1;
+  auto sweeps = Sweeps(5);
+  sweeps.maxdim() = 100;
+  sweeps.mindim() = 100;
+  sweeps.cutoff() = 1E-14;
+  auto psi1 = psi0;
+  auto E = tdvp(psi1,H,Cplx(0,-dt),sweeps,{"Silent",true});
+  CHECK(std::fabs(E-E0) < 1E-8);
+  CHECK(maxLinkDim(psi1) == 8);
+
+  //Once the bonds are complete, TDVP matches
+  //the exact evolution
+  auto exact = noPrime(expHermitian(full(H),Cplx(0,-5*dt))*full(psi1));
+  for(auto nc : {1,2})
+      {
+      auto psi2 = psi1;
+      E = tdvp(psi2,H,Cplx(0,-dt),sweeps,{"Silent",true,"NumCenter",nc});
+      CHECK(std::fabs(E-E0) < 1E-8);
+      CHECK(norm(full(psi2)-exact) < 1E-8);
+      }
+  }
+
+SECTION("TDVP Imaginary Time")
+  {
+  int N = 10;
+  auto sites = SpinHalf(N);
+  auto ampo = AutoMPO(sites);
+  for(int j = 1; j < N; ++j)
+      {
+      ampo += 0.5,"S+",j,"S-",j+1;
+      ampo += 0.5,"S-",j,"S+",j+1;
+      ampo +=     "Sz",j,"Sz",j+1;
+      }
+  auto H = toMPO(ampo);
+
+  auto state = InitState(sites);
+  for(auto j : range1(N)) state.set(j,j%2==1 ? "Up" : "Dn");
+  auto psi0 = MPS(state);
+
+  auto sweeps = Sweeps(5);
+  sweeps.maxdim() = 10,20,40;
+  sweeps.cutoff() = 1E-10;
+  auto [E1,psi1] = dmrg(H,psi0,sweeps,{"Silent",true});
+  (void)psi1;
+
+  auto tsweeps = Sweeps(20);
+  tsweeps.maxdim() = 40;
+  tsweeps.cutoff() = 1E-10;
+  auto psi = psi0;
+  auto E2 = tdvp(psi,H,-1.,tsweeps,{"Silent",true});
+  CHECK(std::fabs(E2-E1) < 1E-5);
+  CHECK_CLOSE(inner(psi,H,psi),E2);
+  CHECK(totalQN(psi) == totalQN(psi0));
+  }
+
 }
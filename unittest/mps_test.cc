@@ -1,5 +1,6 @@
 #include "test.h"
 #include "itensor/mps/mps.h"
+#include "itensor/mps/tevol.h"
 #include "itensor/mps/sites/spinhalf.h"
 #include "itensor/mps/sites/fermion.h"
 #include "itensor/util/print_macro.h"
@@ -352,4 +353,51 @@ SECTION("replaceSiteInds")
       CHECK( siteIndex(psi1_new,n)==siteIndex(psi2,n) );
     }
 
+SECTION("gateTEvol Parallel")
+    {
+    auto sites = SpinHalf(N);
+    auto state = InitState(sites);
+    for(auto j : range1(N)) state.set(j,j%2==1 ? "Up" : "Dn");
+    auto psi0 = MPS(state);
+
+    auto hterm = [&sites](int b)
+        {
+        auto hh = op(sites,"Sz",b)*op(sites,"Sz",b+1);
+        hh += 0.5*op(sites,"S+",b)*op(sites,"S-",b+1);
+        hh += 0.5*op(sites,"S-",b)*op(sites,"S+",b+1);
+        return hh;
+        };
+
+    //Second order Trotter steps in odd/even layers
+    auto dt = 0.05;
+    auto gates = std::vector<BondGate>();
+    for(auto b = 1; b < N; b += 2) gates.push_back(BondGate(sites,b,b+1,BondGate::tReal,dt/2,hterm(b)));
+    for(auto b = 2; b < N; b += 2) gates.push_back(BondGate(sites,b,b+1,BondGate::tReal,dt,hterm(b)));
+    for(auto b = 1; b < N; b += 2) gates.push_back(BondGate(sites,b,b+1,BondGate::tReal,dt/2,hterm(b)));
+
+    auto args = Args{"Cutoff",1E-10,"MaxDim",20,"ShowPercent",false};
+    auto psi1 = psi0;
+    auto nrm1 = gateTEvol(gates,10*dt,dt,psi1,args);
+    auto psi2 = psi0;
+    auto nrm2 = gateTEvol(gates,10*dt,dt,psi2,{args,"Parallel",true,"NThread",4});
+    CHECK(std::fabs(nrm1-nrm2) < 1E-6*nrm1);
+    CHECK(std::abs(innerC(psi1,psi2)) == Approx(1.).epsilon(1E-8));
+    CHECK(maxLinkDim(psi2) == maxLinkDim(psi1));
+
+    //Gates truncated hard at every step
+    //match the serial evolution
+    args = Args{"Cutoff",1E-14,"MaxDim",3,"ShowPercent",false};
+    psi1 = psi0;
+    nrm1 = gateTEvol(gates,20*dt,dt,psi1,args);
+    psi2 = psi0;
+    nrm2 = gateTEvol(gates,20*dt,dt,psi2,{args,"Parallel",true,"NThread",4});
+    CHECK(maxLinkDim(psi1) == 3);
+    CHECK(maxLinkDim(psi2) == 3);
+    CHECK(nrm1 < 1.-1E-5);
+    CHECK(std::fabs(nrm1-nrm2) < 1E-8*nrm1);
+    //psi2 is normalized, not just its tensor on site 1
+    CHECK(std::abs(innerC(psi2,psi2)) == Approx(1.).epsilon(1E-10));
+    CHECK(std::abs(innerC(psi1,psi2)) == Approx(1.).epsilon(1E-8));
+    }
+
 }
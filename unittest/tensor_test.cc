@@ -319,6 +319,47 @@ SECTION("Slicing")
                 }
             }
 
+        SECTION("Copy All Permutations")
+            {
+            //Extents larger than the tiles used by stridedCopy
+            auto T5 = Tensor(37,3,40,1,5);
+            for(auto& el : T5) el = detail::quickran();
+            auto CT5 = CTensor(6,34,2,35,3);
+            for(auto& el : CT5) el = Cplx(detail::quickran(),detail::quickran());
+            auto P = Labels{0,1,2,3,4};
+            auto ndiff = 0;
+            do
+                {
+                auto PT = Tensor(permute(T5,P));
+                for(auto& i : PT.range())
+                    {
+                    if(PT(i) != T5(i[P[0]],i[P[1]],i[P[2]],i[P[3]],i[P[4]])) ++ndiff;
+                    }
+                auto CPT = CTensor(permute(CT5,P));
+                for(auto& i : CPT.range())
+                    {
+                    if(CPT(i) != CT5(i[P[0]],i[P[1]],i[P[2]],i[P[3]],i[P[4]])) ++ndiff;
+                    }
+                } while(std::next_permutation(P.begin(),P.end()));
+            CHECK(ndiff == 0);
+
+            //Large enough to be split over threads
+            auto oldargs = Args::global();
+            Args::global().add("NThread",3);
+            auto T3 = Tensor(70,60,70);
+            for(auto& el : T3) el = detail::quickran();
+            for(auto P3 : {Labels{2,0,1},Labels{1,0,2},Labels{0,2,1}})
+                {
+                auto PT = Tensor(permute(T3,P3));
+                for(auto& i : PT.range())
+                    {
+                    if(PT(i) != T3(i[P3[0]],i[P3[1]],i[P3[2]])) ++ndiff;
+                    }
+                }
+            Args::global() = oldargs;
+            CHECK(ndiff == 0);
+            }
+
         }
 
     SECTION("Sub Tensor")
@@ -3,6 +3,11 @@
 #include "itensor/global.h"
 #include "itensor/util/infarray.h"
 #include "itensor/util/stats.h"
+#include "itensor/util/profiler.h"
+#include "itensor/util/threadpool.h"
+#include "itensor/tensor/mat.h"
+#include <fstream>
+#include <set>
 
 using namespace itensor;
 using namespace std;
@@ -261,3 +266,137 @@ SECTION("BinErr")
     }
 }
 
+
+TEST_CASE("Profiler")
+{
+auto& prof = profiler();
+prof.reset();
+
+SECTION("Disabled")
+    {
+    prof.enable(false);
+        {
+        PROFILE_SCOPE("test_disabled")
+        profileCount(10);
+        }
+    CHECK(prof.stats("test_disabled").count == 0);
+    }
+
+SECTION("Nested")
+    {
+    prof.enable();
+    for(int n = 0; n < 3; ++n)
+        {
+        PROFILE_SCOPE("test_outer")
+        profileCount(1,8);
+        for(int m = 0; m < 2; ++m)
+            {
+            PROFILE_SCOPE("test_inner")
+            profileCount(10,16);
+            }
+        }
+    prof.enable(false);
+    auto outer = prof.stats("test_outer");
+    auto inner = prof.stats("test_outer/test_inner");
+    CHECK(outer.count == 3);
+    CHECK(inner.count == 6);
+    CHECK_CLOSE(inner.flops,60);
+    CHECK_CLOSE(inner.bytes,96);
+    //Counts of the outer scope include the inner one
+    CHECK_CLOSE(outer.flops,63);
+    CHECK_CLOSE(outer.bytes,120);
+    CHECK(outer.time >= inner.time);
+    CHECK(prof.stats("test_inner").count == 0);
+
+    prof.reset();
+    CHECK(prof.stats("test_outer").count == 0);
+    }
+
+SECTION("Gemm Flops")
+    {
+    auto A = Matrix(10,20);
+    auto B = Matrix(20,30);
+    randomize(A);
+    randomize(B);
+    prof.enable();
+        {
+        PROFILE_SCOPE("test_mult")
+        auto C = A*B;
+        }
+    prof.enable(false);
+    CHECK(prof.stats("test_mult/gemm").count == 1);
+    CHECK_CLOSE(prof.stats("test_mult").flops,2*10*20*30);
+    }
+
+SECTION("Trace")
+    {
+    prof.trace();
+        {
+        PROFILE_SCOPE("test_trace")
+        }
+    prof.trace(false);
+    prof.enable(false);
+    auto fname = std::string("profile_test_trace.json");
+    prof.writeTrace(fname);
+    std::ifstream f(fname);
+    auto json = std::string(std::istreambuf_iterator<char>(f),std::istreambuf_iterator<char>());
+    CHECK(json.find("\"name\":\"test_trace\",\"ph\":\"X\"") != std::string::npos);
+    std::remove(fname.c_str());
+    }
+
+prof.reset();
+}
+
+TEST_CASE("ThreadPool")
+{
+auto& pool = threadPool(4);
+
+SECTION("Run")
+    {
+    auto done = std::vector<int>(100,0);
+    pool.run(done.size(),[&done](long n) { done[n] += 1; });
+    CHECK(std::count(done.begin(),done.end(),1) == 100);
+    }
+
+SECTION("Exception")
+    {
+    auto f = [](long n) { if(n == 7) throw ITError("task failed"); };
+    CHECK_THROWS_AS(pool.run(100,f),ITError);
+    CHECK(not pool.busy());
+    //Pool is still usable afterwards
+    auto count = std::atomic<long>{0};
+    pool.run(10,[&count](long) { ++count; });
+    CHECK(count == 10);
+    }
+
+SECTION("Grow")
+    {
+    //Asking for more threads grows the same pool,
+    //so earlier references stay valid
+    auto& big = threadPool(pool.nthread()+2);
+    CHECK(&big == &pool);
+    CHECK(pool.nthread() >= 6);
+    auto done = std::vector<int>(100,0);
+    pool.run(done.size(),[&done](long n) { done[n] += 1; });
+    CHECK(std::count(done.begin(),done.end(),1) == 100);
+    }
+
+SECTION("Thread Count")
+    {
+    //A grown pool still runs on at most
+    //the number of threads asked for
+    threadPool(6);
+    auto ids = std::set<std::thread::id>();
+    std::mutex ids_mutex;
+    auto done = std::vector<int>(100,0);
+    pool.run(done.size(),[&](long n)
+        {
+        done[n] += 1;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        std::lock_guard<std::mutex> lock(ids_mutex);
+        ids.insert(std::this_thread::get_id());
+        },2);
+    CHECK(std::count(done.begin(),done.end(),1) == 100);
+    CHECK(ids.size() <= 2);
+    }
+}